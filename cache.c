@@ -0,0 +1,606 @@
+/* cache.c
+ * Compiled cache of parsed Ethernet POWERLINK EDS/XDD/XDC profiles
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include "cache.h"
+
+#include "packet-epl.h"
+#include "wmem_iarray.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <epan/wmem/wmem.h>
+#include <wsutil/file_util.h>
+#include <wsutil/filesystem.h>
+
+/* A cache file is a parsed profile flattened into fixed size records:
+ *
+ *   struct cache_header
+ *   struct cache_object    [objects], sorted by index
+ *   struct cache_subobject [subobjects], grouped by object
+ *   struct cache_mapping   [mappings]
+ *   char                   [strings], NUL-terminated, referenced by offset
+ *
+ * Subobjects are stored as the ranges the interval array combined them
+ * into, so loading doesn't need to sort or merge anything. Records are
+ * in host byte order, files written elsewhere are rejected and rebuilt.
+ *
+ * An entry stays valid while the profile's size and SHA-1 match. The
+ * profile is only hashed again if its mtime changed.
+ *
+ * Loading keeps the file mapped and only reads the header and the
+ * mappings. Objects are built on their first lookup by binary search
+ * in the object records, which are checked only then, too.
+ */
+
+#define CACHE_DIR        "epl-xdd-cache"
+#define CACHE_MAGIC      "EPLXDDC"
+#define CACHE_BYTE_ORDER 0x01020304
+#define CACHE_VERSION    4
+#define CACHE_NO_STRING  G_MAXUINT32
+
+#define CACHE_HAS_SUBINDICES 0x01
+
+struct cache_header {
+	char magic[8];
+	guint32 byte_order;
+	guint32 version;
+	guint64 source_size;
+	gint64 source_mtime;
+	guint8 source_sha1[20];
+	guint32 path, name;
+	guint32 objects, subobjects, mappings;
+	guint32 strings;
+};
+
+struct cache_od_entry {
+	guint64 value;
+	guint32 name, type;
+	guint16 idx;
+	guint8 type_class;
+	guint8 pad[5];
+};
+
+struct cache_object {
+	struct cache_od_entry info;
+	guint32 flags;
+	guint32 first_subobject, subobjects;
+	guint32 pad;
+};
+
+struct cache_subobject {
+	struct cache_od_entry info;
+	guint32 low, high;
+};
+
+struct cache_mapping {
+	guint64 value;
+	guint16 idx;
+	guint8 subindex;
+	guint8 pad[5];
+};
+
+static char *
+cache_file_path(const char *dir, const char *path)
+{
+	char *name, *file;
+
+	name = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+	file = g_strdup_printf("%s" G_DIR_SEPARATOR_S "%s.bin", dir, name);
+	g_free(name);
+
+	return file;
+}
+
+static gboolean
+source_sha1(const char *path, guint8 digest[20])
+{
+	GMappedFile *file;
+	GChecksum *sha1;
+	gsize len = 20;
+
+	if (!(file = g_mapped_file_new(path, FALSE, NULL)))
+		return FALSE;
+
+	sha1 = g_checksum_new(G_CHECKSUM_SHA1);
+	g_checksum_update(sha1, (const guchar*)g_mapped_file_get_contents(file), g_mapped_file_get_length(file));
+	g_checksum_get_digest(sha1, digest, &len);
+	g_checksum_free(sha1);
+
+	g_mapped_file_unref(file);
+	return TRUE;
+}
+
+gboolean
+profile_stamp_get(struct profile_stamp *stamp, const char *path)
+{
+	ws_statb64 st;
+
+	if (ws_stat64(path, &st) != 0)
+		return FALSE;
+
+	stamp->size   = st.st_size;
+	stamp->mtime  = st.st_mtime;
+	stamp->hashed = FALSE;
+	return TRUE;
+}
+
+gboolean
+profile_stamp_hash(struct profile_stamp *stamp, const char *path)
+{
+	if (!stamp->hashed)
+		stamp->hashed = source_sha1(path, stamp->sha1);
+
+	return stamp->hashed;
+}
+
+gboolean
+profile_stamp_matches(const struct profile_stamp *stamp, const char *path)
+{
+	ws_statb64 st;
+	guint8 sha1[20];
+
+	if (ws_stat64(path, &st) != 0 || (guint64)st.st_size != stamp->size)
+		return FALSE;
+
+	if ((gint64)st.st_mtime == stamp->mtime)
+		return TRUE;
+
+	return stamp->hashed && source_sha1(path, sha1) && memcmp(sha1, stamp->sha1, sizeof sha1) == 0;
+}
+
+/* Reading */
+
+struct cache_view {
+	const struct cache_header *hdr;
+	const struct cache_object *objects;
+	const struct cache_subobject *subobjects;
+	const struct cache_mapping *mappings;
+	const char *strings;
+};
+
+struct profile_cache {
+	GMappedFile *file;
+	struct cache_view view;
+	struct profile *profile;
+};
+
+static gboolean
+cache_string_valid(const struct cache_view *view, guint32 off)
+{
+	/* the string table ends in a NUL, so any offset into it is terminated */
+	return off == CACHE_NO_STRING || off < view->hdr->strings;
+}
+
+static const char *
+cache_string(const struct cache_view *view, guint32 off)
+{
+	return off == CACHE_NO_STRING ? NULL : view->strings + off;
+}
+
+static gboolean
+cache_od_entry_valid(const struct cache_view *view, const struct cache_od_entry *entry)
+{
+	return entry->name != CACHE_NO_STRING
+	    && cache_string_valid(view, entry->name)
+	    && cache_string_valid(view, entry->type);
+}
+
+/* Only the layout is checked here, records are checked when used */
+static gboolean
+cache_view_init(struct cache_view *view, const char *data, gsize len)
+{
+	const struct cache_header *hdr = (const struct cache_header*)data;
+	guint64 size;
+
+	if (!data || len < sizeof *hdr)
+		return FALSE;
+
+	if (memcmp(hdr->magic, CACHE_MAGIC, sizeof hdr->magic) != 0
+	 || hdr->byte_order != CACHE_BYTE_ORDER
+	 || hdr->version != CACHE_VERSION)
+		return FALSE;
+
+	size = sizeof *hdr
+	     + (guint64)hdr->objects    * sizeof (struct cache_object)
+	     + (guint64)hdr->subobjects * sizeof (struct cache_subobject)
+	     + (guint64)hdr->mappings   * sizeof (struct cache_mapping)
+	     + hdr->strings;
+	if (size != len || hdr->strings == 0 || data[len - 1] != '\0')
+		return FALSE;
+
+	view->hdr        = hdr;
+	view->objects    = (const struct cache_object*)(hdr + 1);
+	view->subobjects = (const struct cache_subobject*)(view->objects + hdr->objects);
+	view->mappings   = (const struct cache_mapping*)(view->subobjects + hdr->subobjects);
+	view->strings    = (const char*)(view->mappings + hdr->mappings);
+
+	return hdr->path != CACHE_NO_STRING
+	    && cache_string_valid(view, hdr->path)
+	    && cache_string_valid(view, hdr->name);
+}
+
+static gboolean
+cache_object_valid(const struct cache_view *view, const struct cache_object *cobj)
+{
+	const struct cache_subobject *subobj;
+	guint32 i;
+
+	if (!cache_od_entry_valid(view, &cobj->info))
+		return FALSE;
+	if (!(cobj->flags & CACHE_HAS_SUBINDICES) && cobj->subobjects)
+		return FALSE;
+	if ((guint64)cobj->first_subobject + cobj->subobjects > view->hdr->subobjects)
+		return FALSE;
+
+	for (i = 0; i < cobj->subobjects; i++)
+	{
+		subobj = &view->subobjects[cobj->first_subobject + i];
+		if (!cache_od_entry_valid(view, &subobj->info) || subobj->low > subobj->high || subobj->high > G_MAXUINT8)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+cache_od_entry_get(const struct cache_view *view, const struct cache_od_entry *entry, struct od_entry *info)
+{
+	const char *type = cache_string(view, entry->type);
+
+	info->idx        = entry->idx;
+	info->type_class = entry->type_class;
+	info->type       = type ? epl_type_to_hf(type) : NULL;
+	info->value      = entry->value;
+	g_strlcpy(info->name, cache_string(view, entry->name), sizeof info->name);
+}
+
+static int
+cache_object_cmp(const void *key, const void *elem)
+{
+	guint16 idx = *(const guint16*)key;
+	const struct cache_object *cobj = (const struct cache_object*)elem;
+
+	if (idx < cobj->info.idx) return -1;
+	if (idx > cobj->info.idx) return +1;
+	return 0;
+}
+
+struct object *
+profile_cache_object(struct profile_cache *cache, guint16 idx)
+{
+	const struct cache_view *view = &cache->view;
+	const struct cache_object *cobj;
+	const struct cache_subobject *subobj;
+	struct object *obj;
+	guint32 i;
+
+	cobj = (const struct cache_object*)bsearch(&idx, view->objects, view->hdr->objects, sizeof *cobj, cache_object_cmp);
+	if (!cobj || !cache_object_valid(view, cobj))
+		return NULL;
+
+	obj = profile_object_add(cache->profile, idx);
+	cache_od_entry_get(view, &cobj->info, &obj->info);
+	if (!(cobj->flags & CACHE_HAS_SUBINDICES))
+		return obj;
+
+	obj->subindices = epl_wmem_iarray_new(cache->profile->scope, sizeof (struct subobject), subobject_equal);
+	for (i = 0; i < cobj->subobjects; i++)
+	{
+		struct subobject sub;
+
+		subobj = &view->subobjects[cobj->first_subobject + i];
+		memset(&sub, 0, sizeof sub);
+		cache_od_entry_get(view, &subobj->info, &sub.info);
+		epl_wmem_iarray_append_range(obj->subindices, subobj->low, subobj->high, &sub.range);
+	}
+
+	return obj;
+}
+
+static gboolean
+cache_unmap(wmem_allocator_t *scope _U_, wmem_cb_event_t event _U_, void *data)
+{
+	g_mapped_file_unref(((struct profile_cache*)data)->file);
+	return FALSE;
+}
+
+static void cache_write(const char *dir, const char *cache_path, const guint8 *data, gsize len);
+
+/* Same content under a new mtime, refresh it so we needn't hash again */
+static void
+cache_touch(const char *dir, const char *cache_path, const struct cache_view *view, gsize len, gint64 mtime)
+{
+	guint8 *data = (guint8*)g_malloc(len);
+
+	memcpy(data, view->hdr, len);
+	((struct cache_header*)data)->source_mtime = mtime;
+	cache_write(dir, cache_path, data, len);
+	g_free(data);
+}
+
+char *
+profile_cache_dir(void)
+{
+	return get_persconffile_path(CACHE_DIR, FALSE);
+}
+
+gboolean
+profile_cache_load(const char *dir, struct profile *profile, const char *path, struct profile_stamp *stamp)
+{
+	struct profile_cache *cache;
+	struct cache_view view;
+	GMappedFile *file;
+	char *cache_path;
+	const char *name;
+	guint32 i;
+
+	cache_path = cache_file_path(dir, path);
+	file = g_mapped_file_new(cache_path, FALSE, NULL);
+	if (!file)
+		goto out;
+
+	if (!cache_view_init(&view, g_mapped_file_get_contents(file), g_mapped_file_get_length(file))
+	 || strcmp(cache_string(&view, view.hdr->path), path) != 0
+	 || view.hdr->source_size != stamp->size)
+		goto miss;
+
+	if (view.hdr->source_mtime == stamp->mtime)
+	{
+		memcpy(stamp->sha1, view.hdr->source_sha1, sizeof stamp->sha1);
+		stamp->hashed = TRUE;
+	}
+	else if (profile_stamp_hash(stamp, path)
+	      && memcmp(view.hdr->source_sha1, stamp->sha1, sizeof stamp->sha1) == 0)
+	{
+		cache_touch(dir, cache_path, &view, g_mapped_file_get_length(file), stamp->mtime);
+	}
+	else
+	{
+		goto miss;
+	}
+
+	g_free(cache_path);
+
+	profile->path = wmem_strdup(profile->scope, path);
+	if ((name = cache_string(&view, view.hdr->name)))
+		profile->name = wmem_strdup(profile->scope, name);
+
+	cache = wmem_new(profile->scope, struct profile_cache);
+	cache->file    = file;
+	cache->view    = view;
+	cache->profile = profile;
+	wmem_register_callback(profile->scope, cache_unmap, cache);
+	profile->cache = cache;
+
+	/* Recorded as read, profile_load() builds the PDO mappings from them
+	 * like for a parsed profile, so the preference still applies
+	 */
+	for (i = 0; i < view.hdr->mappings; i++)
+		profile_object_mapping_add(profile, view.mappings[i].idx, view.mappings[i].subindex, view.mappings[i].value);
+
+	return TRUE;
+
+miss:
+	g_mapped_file_unref(file);
+out:
+	g_free(cache_path);
+	return FALSE;
+}
+
+/* Writing */
+
+struct cache_writer {
+	GByteArray *objects, *subobjects, *mappings, *strings;
+	GHashTable *offsets;
+	guint32 nobjects, nsubobjects;
+};
+
+static guint32
+cache_intern(struct cache_writer *w, const char *str)
+{
+	gpointer off;
+
+	if (!str)
+		return CACHE_NO_STRING;
+
+	if (g_hash_table_lookup_extended(w->offsets, str, NULL, &off))
+		return GPOINTER_TO_UINT(off);
+
+	off = GUINT_TO_POINTER(w->strings->len);
+	g_byte_array_append(w->strings, (const guint8*)str, (guint)strlen(str) + 1);
+	g_hash_table_insert(w->offsets, g_strdup(str), off);
+
+	return GPOINTER_TO_UINT(off);
+}
+
+static void
+cache_od_entry_set(struct cache_writer *w, const struct od_entry *info, struct cache_od_entry *entry)
+{
+	memset(entry, 0, sizeof *entry);
+	entry->value      = info->value;
+	entry->name       = cache_intern(w, info->name);
+	entry->type       = cache_intern(w, epl_type_name(info->type));
+	entry->idx        = info->idx;
+	entry->type_class = info->type_class;
+}
+
+static void
+cache_object_collect(void *key _U_, void *value, void *user_data)
+{
+	g_ptr_array_add((GPtrArray*)user_data, value);
+}
+
+static gint
+cache_object_order(gconstpointer a, gconstpointer b)
+{
+	const struct object *x = *(const struct object * const *)a,
+	                    *y = *(const struct object * const *)b;
+
+	return (gint)x->info.idx - (gint)y->info.idx;
+}
+
+static void
+cache_object_write(struct cache_writer *w, const struct object *obj)
+{
+	struct cache_object cobj;
+	guint i, len;
+
+	memset(&cobj, 0, sizeof cobj);
+	cache_od_entry_set(w, &obj->info, &cobj.info);
+
+	if (obj->subindices)
+	{
+		len = epl_wmem_iarray_len(obj->subindices);
+		cobj.flags = CACHE_HAS_SUBINDICES;
+		cobj.first_subobject = w->nsubobjects;
+		cobj.subobjects = len;
+
+		for (i = 0; i < len; i++)
+		{
+			const struct subobject *subobj = (const struct subobject*)epl_wmem_iarray_index(obj->subindices, i);
+			struct cache_subobject csub;
+
+			memset(&csub, 0, sizeof csub);
+			cache_od_entry_set(w, &subobj->info, &csub.info);
+			csub.low  = subobj->range.low;
+			csub.high = subobj->range.high;
+			g_byte_array_append(w->subobjects, (const guint8*)&csub, sizeof csub);
+		}
+		w->nsubobjects += len;
+	}
+
+	g_byte_array_append(w->objects, (const guint8*)&cobj, sizeof cobj);
+	w->nobjects++;
+}
+
+static void
+cache_write(const char *dir, const char *cache_path, const guint8 *data, gsize len)
+{
+	GError *err = NULL;
+
+	if (g_mkdir_with_parents(dir, 0755) != 0)
+		EPL_INFO("Couldn't create profile cache directory %s: %s", dir, g_strerror(errno));
+	else if (!g_file_set_contents(cache_path, (const gchar*)data, len, &err))
+		EPL_INFO("Couldn't write profile cache %s: %s", cache_path, err->message);
+
+	if (err)
+		g_error_free(err);
+}
+
+void
+profile_cache_store(const char *dir, struct profile *profile, const char *path, struct profile_stamp *stamp)
+{
+	struct cache_writer w;
+	struct cache_header hdr;
+	GPtrArray *objects;
+	GByteArray *file;
+	char *cache_path;
+	guint i;
+
+	/* a lazily loaded profile came from the cache, and isn't complete */
+	if (profile->cache)
+		return;
+
+	if (!profile_stamp_hash(stamp, path))
+		return;
+
+	memset(&hdr, 0, sizeof hdr);
+
+	w.objects     = g_byte_array_new();
+	w.subobjects  = g_byte_array_new();
+	w.mappings    = g_byte_array_new();
+	w.strings     = g_byte_array_new();
+	w.offsets     = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	w.nobjects    = 0;
+	w.nsubobjects = 0;
+
+	memcpy(hdr.magic, CACHE_MAGIC, sizeof hdr.magic);
+	hdr.byte_order   = CACHE_BYTE_ORDER;
+	hdr.version      = CACHE_VERSION;
+	hdr.source_size  = stamp->size;
+	hdr.source_mtime = stamp->mtime;
+	memcpy(hdr.source_sha1, stamp->sha1, sizeof hdr.source_sha1);
+	hdr.path         = cache_intern(&w, path);
+	hdr.name         = cache_intern(&w, profile->name);
+
+	/* sorted, so lookups can bsearch the mapped file */
+	objects = g_ptr_array_new();
+	wmem_map_foreach(profile->objects, cache_object_collect, objects);
+	g_ptr_array_sort(objects, cache_object_order);
+	for (i = 0; i < objects->len; i++)
+		cache_object_write(&w, (const struct object*)g_ptr_array_index(objects, i));
+	g_ptr_array_free(objects, TRUE);
+
+	for (i = 0; i < wmem_array_get_count(profile->default_mappings); i++)
+	{
+		const struct profile_mapping *raw = (const struct profile_mapping*)wmem_array_index(profile->default_mappings, i);
+		struct cache_mapping mapping;
+
+		memset(&mapping, 0, sizeof mapping);
+		mapping.value    = raw->value;
+		mapping.idx      = raw->idx;
+		mapping.subindex = raw->subindex;
+		g_byte_array_append(w.mappings, (const guint8*)&mapping, sizeof mapping);
+	}
+
+	hdr.objects    = w.nobjects;
+	hdr.subobjects = w.nsubobjects;
+	hdr.mappings   = wmem_array_get_count(profile->default_mappings);
+	hdr.strings    = w.strings->len;
+
+	file = g_byte_array_sized_new((guint)sizeof hdr + w.objects->len + w.subobjects->len + w.mappings->len + w.strings->len);
+	g_byte_array_append(file, (const guint8*)&hdr, sizeof hdr);
+	g_byte_array_append(file, w.objects->data, w.objects->len);
+	g_byte_array_append(file, w.subobjects->data, w.subobjects->len);
+	g_byte_array_append(file, w.mappings->data, w.mappings->len);
+	g_byte_array_append(file, w.strings->data, w.strings->len);
+
+	cache_path = cache_file_path(dir, path);
+	cache_write(dir, cache_path, file->data, file->len);
+
+	g_free(cache_path);
+	g_byte_array_free(file, TRUE);
+	g_byte_array_free(w.objects, TRUE);
+	g_byte_array_free(w.subobjects, TRUE);
+	g_byte_array_free(w.mappings, TRUE);
+	g_byte_array_free(w.strings, TRUE);
+	g_hash_table_destroy(w.offsets);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
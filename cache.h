@@ -0,0 +1,65 @@
+/* cache.h
+ * Compiled cache of parsed Ethernet POWERLINK EDS/XDD/XDC profiles
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef WIRESHARK_EPL_CACHE_H_
+#define WIRESHARK_EPL_CACHE_H_
+
+#include <glib.h>
+
+struct profile;
+struct profile_stamp;
+struct profile_cache;
+
+/* Stats the profile file, it's hashed by profile_stamp_hash() */
+gboolean profile_stamp_get(struct profile_stamp *stamp, const char *path);
+
+/* Fills in the SHA-1 of the stamped file, unless already done */
+gboolean profile_stamp_hash(struct profile_stamp *stamp, const char *path);
+
+/* Whether the file still has the stamped content. It's only hashed
+ * again if the mtime changed, an unhashed stamp doesn't match then
+ */
+gboolean profile_stamp_matches(const struct profile_stamp *stamp, const char *path);
+
+/* The directory cache entries live in. Wireshark's configuration paths
+ * aren't thread safe, so this is resolved on the main thread and passed
+ * to the functions below
+ */
+char *profile_cache_dir(void);
+
+/* Fills the freshly created profile from the cache entry for path.
+ * Returns FALSE and leaves the profile untouched if there is no entry
+ * or it was written for different content than stamp. The file is
+ * only hashed if its mtime differs from the entry's, the stamp takes
+ * the entry's SHA-1 otherwise.
+ * Objects are left in the cache until profile_cache_object() is asked
+ * for them
+ */
+gboolean profile_cache_load(const char *dir, struct profile *profile, const char *path, struct profile_stamp *stamp);
+
+/* Builds an object of a profile loaded from the cache, NULL if there's none */
+struct object *profile_cache_object(struct profile_cache *cache, guint16 idx);
+
+/* (Re)writes the cache entry for a profile just parsed from path */
+void profile_cache_store(const char *dir, struct profile *profile, const char *path, struct profile_stamp *stamp);
+
+#endif
@@ -66,33 +66,67 @@ epl_strtou16(const char * str, char **endptr, int base)
 	return val;
 }
 
-static guint16
-epl_g_key_file_get_uint16(GKeyFile *gkf, const gchar *group_name, const gchar *key, GError **error)
+/* The EDS is mapped and read in a single pass. Lines, keys and values
+ * are slices of the mapping, only what ends up in the profile is copied
+ */
+struct eds_token {
+	const char *str;
+	gsize len;
+};
+
+static void
+eds_token_trim(struct eds_token *tok)
 {
-	guint32 ret = 0;
-	char *val, *endptr;
-	val = g_key_file_get_string(gkf, group_name, key, error);
-	if (val) /* We need to support XXh, but no octals (is that right?) */
-		ret = epl_strtou16(val, &endptr, epl_ishex(val) ? 16 : 10);
-	g_free(val);
-	return ret;
+	while (tok->len && g_ascii_isspace(*tok->str))
+	{
+		tok->str++;
+		tok->len--;
+	}
+	while (tok->len && g_ascii_isspace(tok->str[tok->len - 1]))
+		tok->len--;
 }
 
-static char *
-epl_strchrnul(const char *s, int c)
+static gboolean
+eds_token_is(const struct eds_token *tok, const char *str)
 {
-	const char *end;
-	if (!s) return NULL;
-	for (end = s; *end && *end != c; end++)
-		;
-	return (char*)end;
+	gsize len = strlen(str);
+	return tok->len == len && g_ascii_strncasecmp(tok->str, str, len) == 0;
 }
 
+/* Up to the first '#', which starts a comment in names */
+static gsize
+eds_token_len_till_comment(const struct eds_token *tok)
+{
+	const char *hash = (const char*)memchr(tok->str, '#', tok->len);
+	return hash ? (gsize)(hash - tok->str) : tok->len;
+}
+
+/* Numbers and section names are short, they are parsed from a copy */
 static char *
-epl_wmem_strdup_till(wmem_allocator_t *allocator, const char *str, char ch)
+eds_token_cstr(const struct eds_token *tok, char *buf, gsize size)
+{
+	gsize len = MIN(tok->len, size - 1);
+	memcpy(buf, tok->str, len);
+	buf[len] = '\0';
+	return buf;
+}
+
+static guint16
+eds_token_to_uint16(const struct eds_token *tok)
 {
-	if (!str) return NULL;
-	return (char*)wmem_strndup(allocator, str, epl_strchrnul(str, ch) - str);
+	char buf[32], *endptr;
+	eds_token_cstr(tok, buf, sizeof buf);
+	/* We need to support XXh, but no octals (is that right?) */
+	return epl_strtou16(buf, &endptr, epl_ishex(buf) ? 16 : 10);
+}
+
+static guint64
+eds_token_to_uint64(const struct eds_token *tok)
+{
+	char buf[32], *endptr;
+	eds_token_cstr(tok, buf, sizeof buf);
+	/* $NODEID based values are left at 0 */
+	return g_ascii_strtoull(buf, &endptr, epl_ishex(buf) ? 16 : 10);
 }
 
 static void
@@ -158,96 +192,202 @@ eds_free(void)
 {
 }
 
+enum eds_section_kind {
+	EDS_SECTION_OTHER,
+	EDS_SECTION_FILEINFO,
+	EDS_SECTION_OBJECT,    /* [XXXX] */
+	EDS_SECTION_SUBOBJECT  /* [XXXXsubYY] */
+};
+
+struct eds_section {
+	enum eds_section_kind kind;
+	guint16 idx;
+	struct od_entry info;
+};
+
+static void
+eds_section_begin(struct eds_section *sec, const struct eds_token *name)
+{
+	char buf[32], *endptr;
+	guint16 idx;
+
+	memset(sec, 0, sizeof *sec);
+	sec->kind = EDS_SECTION_OTHER;
+
+	if (eds_token_is(name, "FileInfo"))
+	{
+		sec->kind = EDS_SECTION_FILEINFO;
+		return;
+	}
+
+	if (!name->len || name->len >= sizeof buf || !g_ascii_isxdigit(*name->str))
+		return;
+
+	eds_token_cstr(name, buf, sizeof buf);
+	idx = epl_strtou16(buf, &endptr, 16);
+	if (*endptr == '\0')
+	{ /* index */
+		sec->kind = EDS_SECTION_OBJECT;
+		sec->idx = idx;
+		sec->info.idx = idx;
+	}
+	else if (g_ascii_strncasecmp(endptr, "sub", 3) == 0)
+	{ /* subindex */
+		sec->info.idx = epl_strtou16(endptr + 3, &endptr, 16);
+		if (sec->info.idx > 0xFF)
+			return;
+		sec->kind = EDS_SECTION_SUBOBJECT;
+		sec->idx = idx;
+	}
+}
+
+static void
+eds_section_key(struct profile *profile, struct eds_section *sec, const struct eds_token *key, const struct eds_token *val)
+{
+	gsize len;
+
+	switch (sec->kind)
+	{
+		case EDS_SECTION_FILEINFO:
+			if (!eds_token_is(key, "Description"))
+				break;
+			len = eds_token_len_till_comment(val);
+			if (g_utf8_validate(val->str, len, NULL))
+				profile->name = wmem_strndup(profile->scope, val->str, len);
+			break;
+		case EDS_SECTION_OBJECT:
+		case EDS_SECTION_SUBOBJECT:
+			if (eds_token_is(key, "ObjectType"))
+			{
+				sec->info.type_class = (guint8)eds_token_to_uint16(val);
+			}
+			else if (eds_token_is(key, "DataType"))
+			{
+				guint16 DataType = eds_token_to_uint16(val);
+				sec->info.type = DataType ? (const struct epl_datatype*)wmem_map_lookup(dataTypeMap, &DataType) : NULL;
+			}
+			else if (eds_token_is(key, "ParameterName"))
+			{
+				len = eds_token_len_till_comment(val);
+				if (!g_utf8_validate(val->str, len, NULL))
+					len = 0;
+				len = MIN(len, sizeof sec->info.name - 1);
+				memcpy(sec->info.name, val->str, len);
+				sec->info.name[len] = '\0';
+			}
+			else if (eds_token_is(key, "DefaultValue"))
+			{
+				sec->info.value = eds_token_to_uint64(val);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static void
+eds_section_end(struct profile *profile, const struct eds_section *sec)
+{
+	struct object *obj;
+
+	if (sec->kind != EDS_SECTION_OBJECT && sec->kind != EDS_SECTION_SUBOBJECT)
+		return;
+	if (!sec->info.type_class)
+		return;
+
+	obj = profile_object_lookup_or_add(profile, sec->idx);
+
+	if (sec->kind == EDS_SECTION_OBJECT)
+	{ /* Let's add a new object! Exciting! */
+		obj->info = sec->info;
+	}
+	else
+	{ /* Object already there, let's add subindices */
+		struct subobject subobj = {0};
+		if (!obj->subindices)
+		{
+			obj->subindices = epl_wmem_iarray_new(
+					profile->scope,
+					sizeof (struct subobject),
+					subobject_equal
+			);
+		}
+
+		subobj.info = sec->info;
+		epl_wmem_iarray_insert(obj->subindices, subobj.info.idx, &subobj.range);
+	}
+}
+
 struct profile *
 eds_load(struct profile *profile, const char *eds_file)
 {
-	GKeyFile* gkf;
-	GError *err;
-	char **group, **groups;
-	char *val;
-	gsize groups_count;
-
-	gkf = g_key_file_new();
+	GMappedFile *file;
+	GError *err = NULL;
+	const char *p, *end, *eol;
+	struct eds_section sec;
+	struct eds_token line, key, val;
 
 	/* Load EDS document */
-	if (!g_key_file_load_from_file(gkf, eds_file, G_KEY_FILE_NONE, &err)){
+	if (!(file = g_mapped_file_new(eds_file, FALSE, &err)))
+	{
 		g_warning("Error: unable to parse file \"%s\"\n", eds_file);
-		profile = NULL;
-		goto cleanup;
+		g_error_free(err);
+		return NULL;
 	}
 
 	profile->path = wmem_strdup(profile->scope, eds_file);
 
-	val = g_key_file_get_string(gkf, "FileInfo", "Description", NULL);
-	profile->name = epl_wmem_strdup_till(profile->scope, val, '#');
-	g_free(val);
+	p   = g_mapped_file_get_contents(file);
+	end = p + g_mapped_file_get_length(file);
+	if (end - p >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+		p += 3;
 
-	groups = g_key_file_get_groups(gkf, &groups_count);
-	for (group = groups; *group; group++)
+	memset(&sec, 0, sizeof sec);
+	sec.kind = EDS_SECTION_OTHER;
+
+	while (p < end)
 	{
-		char *endptr, *name;
-		guint16 idx, DataType;
-		struct object *obj = NULL;
-		struct od_entry tmpobj = {0};
-		gboolean is_object = TRUE;
-		
-		if (!g_ascii_isxdigit(**group))
-			continue;
+		const char *eq;
 
-		idx = epl_strtou16(*group, &endptr, 16);
-		if (*endptr == '\0')
-		{ /* index */
-			tmpobj.idx = idx;
-		}
-		else if (g_str_has_prefix(endptr, "sub"))
-		{ /* subindex */
-			tmpobj.idx = epl_strtou16(endptr + 3, &endptr, 16);
-			if (tmpobj.idx > 0xFF) continue;
-			is_object = FALSE;
-		}
-		else continue;
-		
-		tmpobj.type_class = epl_g_key_file_get_uint16(gkf, *group, "ObjectType", NULL);
-		if (!tmpobj.type_class)
-			continue; 
+		eol = (const char*)memchr(p, '\n', end - p);
+		line.str = p;
+		line.len = (eol ? eol : end) - p;
+		p = eol ? eol + 1 : end;
 
-		DataType = epl_g_key_file_get_uint16(gkf, *group, "DataType", NULL);
-		if (DataType)
-			tmpobj.type = (const struct epl_datatype*)wmem_map_lookup(dataTypeMap, &DataType);
+		eds_token_trim(&line);
+		if (!line.len || *line.str == ';' || *line.str == '#')
+			continue;
 
-		if ((name = g_key_file_get_string(gkf, *group, "ParameterName", NULL)))
+		if (*line.str == '[')
 		{
-			gsize count = epl_strchrnul(name, '#') - name + 1;
-			g_strlcpy(
-					tmpobj.name,
-					name,
-					count > sizeof tmpobj.name ? sizeof tmpobj.name : count
-			);
-			g_free(name);
-		}
+			const char *close = (const char*)memchr(line.str, ']', line.len);
+			if (!close)
+				continue;
 
-		obj = profile_object_lookup_or_add(profile, idx);
+			eds_section_end(profile, &sec);
 
-		if (is_object)
-		{ /* Let's add a new object! Exciting! */
-			obj->info = tmpobj;
+			key.str = line.str + 1;
+			key.len = close - key.str;
+			eds_token_trim(&key);
+			eds_section_begin(&sec, &key);
+			continue;
 		}
-		else
-		{ /* Object already there, let's add subindices */
-			struct subobject subobj = {0};
-			if (!obj->subindices)
-			{
-				obj->subindices = epl_wmem_iarray_new(
-						profile->scope,
-						sizeof (struct subobject),
-						subobject_equal
-				);
-			}
 
-			subobj.info = tmpobj;
-			epl_wmem_iarray_insert(obj->subindices, subobj.info.idx, &subobj.range);
-		}
+		if (sec.kind == EDS_SECTION_OTHER || !(eq = (const char*)memchr(line.str, '=', line.len)))
+			continue;
+
+		key.str = line.str;
+		key.len = eq - line.str;
+		val.str = eq + 1;
+		val.len = line.str + line.len - val.str;
+		eds_token_trim(&key);
+		eds_token_trim(&val);
+
+		eds_section_key(profile, &sec, &key, &val);
 	}
+	eds_section_end(profile, &sec);
+
+	g_mapped_file_unref(file);
 
 	/* Unlike with XDDs, subindices might interleave with others, so let's sort them now */
 	wmem_map_foreach(profile->objects, sort_subindices, NULL);
@@ -255,8 +395,6 @@ eds_load(struct profile *profile, const char *eds_file)
 	/* We don't read object mappings from EDS files */
 	/*   profile_object_mappings_update(profile);   */
 
-cleanup:
-	g_key_file_free(gkf);
 	return profile;
 }
 
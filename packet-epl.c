@@ -67,6 +67,8 @@
 	#define IF_LIBXML(x)
 #endif /* !HAVE_LIBXML2 */
 #include "eds.h"
+#include "stats.h"
+#include "cache.h"
 #include "wmem_iarray.h"
 
 #include <epan/conversation.h>
@@ -77,7 +79,10 @@
 #include <epan/reassemble.h>
 #include <epan/proto_data.h>
 #include <epan/uat.h>
+#include <epan/crc32-tvb.h>
+#include <epan/tap.h>
 #include <wsutil/file_util.h>
+#include <wsutil/pint.h>
 #include <wsutil/report_err.h>
 #include <glib.h>
 #include <string.h>
@@ -95,12 +100,6 @@ void proto_reg_handoff_epl(void);
 static heur_dissector_list_t heur_epl_subdissector_list;
 static heur_dissector_list_t heur_epl_data_subdissector_list;
 static dissector_table_t     epl_asnd_dissector_table;
-#if 0
-/* Container for tapping relevant data */
-typedef struct _epl_info_t {
-	unsigned char epl_mtyp;
-} epl_info_t;
-#endif
 
 /*EPL Addressing*/
 #define EPL_DYNAMIC_NODEID                        0
@@ -153,18 +152,18 @@ static const gchar* addr_str_abbr_res = " (res.)";
 
 #define EPL_ASND_SVID_OFFSET        3
 #define EPL_ASND_DATA_OFFSET        4
+/* IdentResponse, relative to the ASnd data */
+#define EPL_ASND_IRES_NMT_OFFSET    2
+#define EPL_ASND_IRES_RST_OFFSET    16
+#define EPL_ASND_IRES_DT_OFFSET     22
+#define EPL_ASND_IRES_VID_OFFSET    26
+#define EPL_ASND_IRES_PC_OFFSET     30
+#define EPL_ASND_IRES_HN_OFFSET     78
+#define EPL_ASND_IRES_VEX2_OFFSET   110
+#define EPL_ASND_IRES_SIZE          (EPL_ASND_IRES_VEX2_OFFSET + 48)
 /* NMT Command DNA size */
 #define EPL_SIZEOF_NMTCOMMAND_DNA   27
 
-/* EPL message types */
-#define EPL_SOC     0x01
-#define EPL_PREQ    0x03
-#define EPL_PRES    0x04
-#define EPL_SOA     0x05
-#define EPL_ASND    0x06
-#define EPL_AMNI    0x07
-#define EPL_AINV    0x0D
-
 static const value_string mtyp_vals[] = {
 	{EPL_SOC,  "Start of Cycle (SoC)"         },
 	{EPL_PREQ, "PollRequest (PReq)"           },
@@ -447,38 +446,44 @@ static const value_string errorcode_vals[] = {
 
 static value_string_ext errorcode_vals_ext = VALUE_STRING_EXT_INIT(errorcode_vals);
 
-/* duplication table key */
-typedef struct {
-	guint8 src;
-	guint8 dest;
-	guint8 seq_send;
-	guint8 seq_recv;
-} duplication_key;
-
-/* duplication table value */
-typedef struct {
+/* last frame seen per (recv,send) sequence pair of one SDO connection,
+ * a slot is only valid if its generation matches the current one */
+struct sdo_seq_frames_slot {
 	guint32 frame;
-} duplication_data;
+	guint32 generation;
+};
 
-static guint32 ct = 0;
-static guint32 count = 0;
+struct sdo_seq_frames {
+	guint32 generation;
+	struct sdo_seq_frames_slot slots[EPL_MAX_SEQUENCE][EPL_MAX_SEQUENCE];
+};
 
-typedef struct _epl_sdo_reassembly
-{
-	guint32 frame[EPL_MAX_SEQUENCE][EPL_MAX_SEQUENCE];
-} epl_sdo_reassembly;
+/* running totals of a streamed transfer, nothing of the data is kept */
+struct sdo_stream {
+	guint32 size;     /* as announced by the initiate segment */
+	guint32 length;
+	guint32 segments;
+	guint32 crc;
+	guint32 first_cycle;
+	guint32 cycles;
+};
+
+/* segmented transfer in one direction of a (src,dest) pair */
+struct sdo_transfer {
+	guint32 seq;
+	gboolean first;
+	struct sdo_stream stream;
+	struct sdo_seq_frames frames;
+};
 
-static struct _epl_segmentation{
+/* addressing of the SDO frame being dissected */
+struct epl_segmentation {
 	guint8 src;
 	guint8 dest;
 	guint8 recv;
 	guint8 send;
-} epl_segmentation;
-
-static epl_sdo_reassembly epl_asnd_sdo_reassembly_write;
-static epl_sdo_reassembly epl_asnd_sdo_reassembly_read;
-static gboolean first_read = TRUE;
-static gboolean first_write = TRUE;
+	struct epl_sdo_info *info; /* for the tap */
+};
 
 /* Priority values for EPL message type "ASnd", "", "", field PR */
 #define EPL_PR_GENERICREQUEST   0x03
@@ -645,25 +650,6 @@ static const value_string epl_sdo_init_con_vals[] = {
 #define EPL_ASND_SDO_CMD_ABORT_TRANSFER_OK                  0
 #define EPL_ASND_SDO_CMD_ABORT_ABORT_TRANSFER               1
 
-#define EPL_ASND_SDO_CMD_SEGMENTATION_EPEDITED_TRANSFER     0
-#define EPL_ASND_SDO_CMD_SEGMENTATION_INITIATE_TRANSFER     1
-#define EPL_ASND_SDO_CMD_SEGMENTATION_SEGMENT               2
-#define EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE     3
-
-#define EPL_ASND_SDO_COMMAND_NOT_IN_LIST                        0x00
-#define EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX                     0x01
-#define EPL_ASND_SDO_COMMAND_READ_BY_INDEX                      0x02
-#define EPL_ASND_SDO_COMMAND_WRITE_ALL_BY_INDEX                 0x03
-#define EPL_ASND_SDO_COMMAND_READ_ALL_BY_INDEX                  0x04
-#define EPL_ASND_SDO_COMMAND_WRITE_BY_NAME                      0x05
-#define EPL_ASND_SDO_COMMAND_READ_BY_NAME                       0x06
-#define EPL_ASND_SDO_COMMAND_FILE_WRITE                         0x20
-#define EPL_ASND_SDO_COMMAND_FILE_READ                          0x21
-#define EPL_ASND_SDO_COMMAND_WRITE_MULTIPLE_PARAMETER_BY_INDEX  0x31
-#define EPL_ASND_SDO_COMMAND_READ_MULTIPLE_PARAMETER_BY_INDEX   0x32
-#define EPL_ASND_SDO_COMMAND_MAXIMUM_SEGMENT_SIZE               0x70
-#define EPL_ASND_SDO_COMMAND_LINK_NAME_TO_INDEX                 0x71
-
 /* OD indexes */
 #define EPL_SOD_CYLE_LEN        0x1006
 #define EPL_SOD_PDO_RX_COMM     0x1400
@@ -1245,27 +1231,27 @@ static const gchar* addr_str_res = " (reserved)";
 struct epl_convo;
 
 static gint dissect_epl_payload(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, gint len, const struct epl_datatype *type, guint8 msgType);
-static gint dissect_epl_soc(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_preq(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_pres(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_soa(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_soc(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_preq(struct epl_info *info, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_pres(struct epl_info *info, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_soa(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
 
-static gint dissect_epl_asnd_ires(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_asnd_sres(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_asnd_ires(struct epl_info *info, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_asnd_sres(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
 static gint dissect_epl_asnd_nmtcmd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
 static gint dissect_epl_asnd_nmtreq(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
 static gint dissect_epl_asnd_nmtdna(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_asnd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_ainv(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_asnd(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_ainv(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
 
-static gint dissect_epl_asnd_sdo(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
+static gint dissect_epl_asnd_sdo(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
 static gint dissect_epl_asnd_resp(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset);
-static gint dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 *seq);
-static gint dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 seq);
-static gint dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size);
+static gint dissect_epl_sdo_sequence(struct epl_segmentation *segmentation, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 *seq);
+static gint dissect_epl_sdo_command(struct epl_segmentation *segmentation, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 seq);
+static gint dissect_epl_sdo_command_write_by_index(struct epl_segmentation *segmentation, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size);
 static gint dissect_epl_sdo_command_write_multiple_by_index(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size);
-static gint dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size);
-static gint dissect_object_mapping(struct profile *profile, wmem_array_t *mappings, proto_tree *epl_tree, tvbuff_t *tvb, guint32 framenum, gint offset, guint16 idx, guint8 subindex);
+static gint dissect_epl_sdo_command_read_by_index(struct epl_segmentation *segmentation, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size);
+static gint dissect_object_mapping(struct profile *profile, struct object_mappings *mappings, proto_tree *epl_tree, tvbuff_t *tvb, guint32 framenum, gint offset, guint16 idx, guint8 subindex);
 
 static const gchar* decode_epl_address(guchar adr);
 
@@ -1482,6 +1468,13 @@ static gint hf_epl_asnd_sdo_cmd_data_mapping_length          = -1;
 /*static gint hf_epl_asnd_sdo_cmd_data_response      = -1;*/
 
 static gint hf_epl_asnd_sdo_cmd_reassembled                  = -1;
+static gint hf_epl_asnd_sdo_cmd_stream                       = -1;
+static gint hf_epl_asnd_sdo_cmd_stream_size                  = -1;
+static gint hf_epl_asnd_sdo_cmd_stream_length                = -1;
+static gint hf_epl_asnd_sdo_cmd_stream_segments              = -1;
+static gint hf_epl_asnd_sdo_cmd_stream_crc                   = -1;
+static gint hf_epl_asnd_sdo_cmd_stream_cycles                = -1;
+static gint hf_epl_asnd_sdo_cmd_stream_bytes_per_cycle       = -1;
 static gint hf_epl_fragments                                 = -1;
 static gint hf_epl_fragment                                  = -1;
 static gint hf_epl_fragment_overlap                          = -1;
@@ -1588,6 +1581,12 @@ epl_datatype *epl_type_to_hf(const char *name)
 	return NULL;
 }
 
+const char *
+epl_type_name(const struct epl_datatype *type)
+{
+	return type ? type->name : NULL;
+}
+
 
 static gint ett_epl_fragment                                 = -1;
 static gint ett_epl_fragments                                = -1;
@@ -1658,10 +1657,33 @@ static dissector_handle_t epl_handle;
 static gboolean show_cmd_layer_for_duplicated = FALSE;
 static gboolean show_pdo_meta_info = FALSE;
 static gboolean read_xdc_for_mappings = TRUE;
+static gboolean stream_sdo_transfers = FALSE;
+static gboolean cache_profiles = TRUE;
 
 static gint ett_epl_asnd_sdo_data_reassembled = -1;
+static gint ett_epl_asnd_sdo_stream = -1;
+
+struct epl_node_convo;
+
+/* everything the dissection of one capture file mutates, looked up by
+ * the epan session dissecting it with epl_capture_get() and destroyed
+ * along with the file scope
+ */
+struct epl_capture {
+	const struct epan_session *epan;
+	reassembly_table reassembly;
+	wmem_map_t *duplication;   /* (src,dest) -> struct sdo_seq_frames */
+	wmem_map_t *sdo_transfers; /* (src,dest,read) -> struct sdo_transfer */
+	wmem_allocator_t *pdo_mapping_scope;
+	struct epl_node_convo *node_convos[256];
+	guint32 cycles;            /* SoCs seen on the first pass */
+};
+
+/* epan session -> struct epl_capture */
+static GHashTable *epl_captures;
+G_LOCK_DEFINE_STATIC(epl_captures);
 
-static reassembly_table epl_reassembly_table;
+static struct epl_capture *epl_capture_get(packet_info *pinfo);
 
 
 gboolean
@@ -1699,7 +1721,6 @@ epl_address_equal(gconstpointer a, gconstpointer b)
 	return addresses_equal((const address*)a, (const address*)b);
 }
 
-static wmem_allocator_t *pdo_mapping_scope;
 struct object_mapping {
 	struct {
 		guint16 idx;
@@ -1719,21 +1740,165 @@ struct object_mapping {
 	const char *title;
 };
 
+/* A decode plan is the flattened form of a mapping table: Everything
+ * dissect_epl_pdo needs per mapped object is resolved once when the
+ * mappings change, instead of once per PReq/PRes
+ */
+struct pdo_plan_entry {
+	guint32 first_frame;
+	guint map; /* index of the mapping, its last frame can still change */
+	guint16 bit_offset;
+	guint16 no_of_bits;
+	guint16 byte_len;
+
+	/* How the object's bits are taken out of the payload:
+	 * ALIGNED objects are read in place at byte_offset, BITS objects of up
+	 * to 64 bits are shifted and masked out of the bytes they span and
+	 * only the rest still needs an octet aligned copy. Unaligned objects
+	 * that fill their type are COPY too, so they keep their type's field,
+	 * but the scalar ones among them (see kind) are still shifted out of
+	 * the bytes they span and only reals and strings get copied.
+	 */
+	enum { PDO_EXTRACT_ALIGNED, PDO_EXTRACT_BITS, PDO_EXTRACT_COPY } extract;
+	guint16 byte_offset;
+	guint16 span_len; /* bytes touched by an unaligned object */
+	guint8 kind; /* enum epl_pdo_value_kind the object is unpacked as */
+
+	int hf; /* -1 if the type is unknown or doesn't fit the mapping */
+	guint encoding;
+	int ett;
+	const char *title;
+
+	struct {
+		guint16 idx;
+		guint8 subindex;
+	} pdo, param;
+	const char *index_name;
+	const char *subindex_name;
+};
+
+/* The set of mappings active for a frame only changes when an SDO write
+ * (re)maps an object. Each epoch is an immutable snapshot of the plan
+ * entries active for the frames [first, last), so a PDO frame finds its
+ * plan with one binary search instead of filtering on life times.
+ * A remap only changes the active sets from its frame on, so only the
+ * epochs from there are built again.
+ */
+struct pdo_epoch {
+	guint32 first, last;
+	const struct pdo_plan_entry *entries;
+	guint count;
+};
+
+/* Mappings are stored in the order they were added, so they keep their
+ * index. order holds these indices sorted by (bit_offset, frame.first),
+ * ties in the order they were added. Inserting and finding a position
+ * take logarithmic time, the mappings overlapping a new one are found by
+ * walking on from there: no mapping is longer than max_bits, so only
+ * those starting less than max_bits before it can overlap.
+ * Writing an ObjectMapping parameter again ends the mappings it made
+ * before. by_param remembers which ones that were.
+ * A node starts out with its profile's default mappings. Until these
+ * are changed, it reads them (and their plan) through shared instead
+ * of keeping a copy.
+ */
+struct object_mappings {
+	wmem_allocator_t *scope;
+	wmem_array_t *arr;
+	GSequence *order;
+	struct object_mapping probe; /* position looked for in order */
+	guint16 max_bits;
+	wmem_map_t *by_param;
+	struct object_mappings *shared;
+
+	struct pdo_epoch *epochs;
+	guint epochs_len, epochs_size;
+	guint32 stale_from; /* epochs are valid before this frame, G_MAXUINT32 if all are */
+};
+
+/* The mappings an ObjectMapping parameter made last, in frame first */
+struct object_mapping_param {
+	guint32 first;
+	guint *maps;
+	guint len, size;
+};
+
+static gboolean
+object_mappings_del_cb(wmem_allocator_t *pool _U_, wmem_cb_event_t event _U_, void *order)
+{
+	g_sequence_free((GSequence*)order);
+	return FALSE;
+}
+
+static struct object_mappings *
+object_mappings_new(wmem_allocator_t *scope)
+{
+	struct object_mappings *mappings = wmem_new0(scope, struct object_mappings);
+	mappings->scope = scope;
+	mappings->arr = wmem_array_new(scope, sizeof (struct object_mapping));
+	mappings->order = g_sequence_new(NULL);
+	wmem_register_callback(scope, object_mappings_del_cb, mappings->order);
+	mappings->by_param = wmem_map_new(scope, g_direct_hash, g_direct_equal);
+	mappings->stale_from = 0;
+	return mappings;
+}
+
+static void
+object_mappings_invalidate(struct object_mappings *mappings, guint32 framenum)
+{
+	if (framenum < mappings->stale_from)
+		mappings->stale_from = framenum;
+}
+
+#define OBJECT_MAPPINGS_RESOLVE(mappings) \
+	((mappings)->shared ? (mappings)->shared : (mappings))
+
 static struct object_mapping *
-get_object_mappings(wmem_array_t *arr, guint *len)
+get_object_mappings(struct object_mappings *mappings, guint *len)
+{
+	mappings = OBJECT_MAPPINGS_RESOLVE(mappings);
+	*len = wmem_array_get_count(mappings->arr);
+	return (struct object_mapping*)wmem_array_get_raw(mappings->arr);
+}
+
+static guint
+object_mappings_count(struct object_mappings *mappings)
 {
-	*len = wmem_array_get_count(arr);
-	return (struct object_mapping*)wmem_array_get_raw(arr);
+	return wmem_array_get_count(OBJECT_MAPPINGS_RESOLVE(mappings)->arr);
 }
+
+/* Makes an empty dst read src's mappings until it's written to */
+static void
+object_mappings_share(struct object_mappings *dst, struct object_mappings *src)
+{
+	if (object_mappings_count(dst))
+		return;
+	dst->shared = OBJECT_MAPPINGS_RESOLVE(src);
+}
+
+#define OBJECT_MAPPING_PARAM_KEY(map) \
+	GUINT_TO_POINTER(((guint32)(map)->param.idx << 8) | (map)->param.subindex)
+
+/* Stands for mappings->probe in order's comparisons */
+#define OBJECT_MAPPINGS_PROBE GUINT_TO_POINTER(G_MAXUINT)
+
+static int
+object_mapping_pos_cmp(const struct object_mapping *map, guint16 bit_offset, guint32 first)
+{
+	if (map->bit_offset < bit_offset) return -1;
+	if (map->bit_offset > bit_offset) return +1;
+	if (map->frame.first < first) return -1;
+	if (map->frame.first > first) return +1;
+	return 0;
+}
+
 int
 object_mapping_cmp(const void *_a, const void *_b)
 {
 	const struct object_mapping *a = (const struct object_mapping*)_a;
 	const struct object_mapping *b = (const struct object_mapping*)_b;
 
-	if (a->bit_offset < b->bit_offset) return -1;
-	if (a->bit_offset > b->bit_offset) return +1;
-	return 0;
+	return object_mapping_pos_cmp(a, b->bit_offset, b->frame.first);
 }
 gboolean
 object_mapping_eq(struct object_mapping *a, struct object_mapping *b)
@@ -1744,289 +1909,960 @@ object_mapping_eq(struct object_mapping *a, struct object_mapping *b)
 	    && a->param.idx == b->param.idx
 	    && a->param.subindex == b->param.subindex;
 }
-static guint
-add_object_mapping(wmem_array_t *arr, struct object_mapping *mapping)
-{
-	/* let's check if this overwrites an existing mapping */
-	guint i, len;
-	/* A bit ineffecient (looping backwards would be better), but it's acyclic anyway */
-	struct object_mapping *old = get_object_mappings(arr, &len);
-	for (i = 0; i < len; i++)
-	{
-		if (object_mapping_eq(&old[i], mapping))
-			return len;
-
-		if (old[i].frame.first < mapping->frame.first
-		  && (CHECK_OVERLAP_LENGTH(old[i].bit_offset, old[i].no_of_bits, mapping->bit_offset, mapping->no_of_bits)
-		  || (old[i].param.idx == mapping->param.idx && old[i].param.subindex == mapping->param.subindex
-		  && CHECK_OVERLAP_ENDS(old[i].frame.first, old[i].frame.last, mapping->frame.first, mapping->frame.last))))
-		{
-			old[i].frame.last = mapping->frame.first;
-		}
-	}
 
-	wmem_array_append(arr, mapping, 1);
-	wmem_array_sort(arr, object_mapping_cmp);
-	return len + 1;
+static struct object_mapping *
+object_mappings_index(struct object_mappings *mappings, gconstpointer idx)
+{
+	if (idx == OBJECT_MAPPINGS_PROBE)
+		return &mappings->probe;
+	return (struct object_mapping*)wmem_array_index(mappings->arr, GPOINTER_TO_UINT(idx));
 }
 
-static wmem_map_t *epl_profiles_by_device, *epl_profiles_by_nodeid, *epl_profiles_by_address;
-static struct profile *epl_default_profile;
-const char *epl_default_profile_path;
-
-static gboolean
-profile_del_cb(wmem_allocator_t *pool _U_, wmem_cb_event_t event _U_, void *_profile)
+/* Orders indices in order by their mapping's position, then by index.
+ * The probe goes before the mappings at its position
+ */
+static gint
+object_mappings_order_cmp(gconstpointer a, gconstpointer b, gpointer _mappings)
 {
-	struct profile *profile = (struct profile*)_profile;
-	if (profile->parent_map)
-		wmem_map_remove(profile->parent_map, profile->data);
-	wmem_destroy_allocator(profile->scope);
-	return FALSE;
+	struct object_mappings *mappings = (struct object_mappings*)_mappings;
+	int cmp = object_mapping_cmp(object_mappings_index(mappings, a), object_mappings_index(mappings, b));
+
+	if (cmp || a == b)
+		return cmp;
+	if (a == OBJECT_MAPPINGS_PROBE) return -1;
+	if (b == OBJECT_MAPPINGS_PROBE) return +1;
+	return GPOINTER_TO_UINT(a) < GPOINTER_TO_UINT(b) ? -1 : +1;
 }
 
-static void
-profile_del(struct profile *profile)
+/* First position in order not before (bit_offset, first) */
+static GSequenceIter *
+object_mappings_lower_bound(struct object_mappings *mappings, guint16 bit_offset, guint32 first)
 {
-	if (!profile) return;
-	wmem_unregister_callback(profile->parent_scope, profile->cb_id);
-	profile_del_cb(NULL, WMEM_CB_DESTROY_EVENT, profile);
+	mappings = OBJECT_MAPPINGS_RESOLVE(mappings);
+	mappings->probe.bit_offset = bit_offset;
+	mappings->probe.frame.first = first;
+
+	return g_sequence_search(mappings->order, OBJECT_MAPPINGS_PROBE, object_mappings_order_cmp, mappings);
 }
 
-static struct profile *
-profile_new(wmem_allocator_t *parent_pool)
+/* The mapping at it or NULL at the end of order */
+static struct object_mapping *
+object_mappings_iter_get(struct object_mappings *mappings, GSequenceIter *it)
 {
-	wmem_allocator_t *pool;
-	struct profile *profile;
-	
-	pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
-	profile = wmem_new0(pool, struct profile);
-	profile->cb_id = wmem_register_callback(parent_pool, profile_del_cb, profile);
+	if (g_sequence_iter_is_end(it))
+		return NULL;
+	return object_mappings_index(OBJECT_MAPPINGS_RESOLVE(mappings), g_sequence_get(it));
+}
 
-	profile->scope        = pool;
-	profile->parent_scope = parent_pool;
-	profile->parent_map   = NULL;
-	profile->objects      = wmem_map_new(pool, epl_g_int16_hash, epl_g_int16_equal);
-	profile->name         = NULL;
-	profile->path         = NULL;
-	profile->RPDO         = wmem_array_new(pool, sizeof (struct object_mapping));
-	profile->TPDO         = wmem_array_new(pool, sizeof (struct object_mapping));
-	profile->next         = NULL;
+/* Plan entries outlive changes to their mapping's last frame, so it's looked up */
+static guint32
+object_mappings_last_frame(struct object_mappings *mappings, const struct pdo_plan_entry *entry)
+{
+	guint len;
+	struct object_mapping *maps = get_object_mappings(mappings, &len);
 
-	return profile;
+	return entry->map < len ? maps[entry->map].frame.last : G_MAXUINT32;
 }
 
-struct object *
-profile_object_add(struct profile *profile, guint16 idx)
+static void
+object_mappings_remember_param(struct object_mappings *mappings, guint idx)
 {
-	struct object *object = wmem_new0(profile->scope, struct object);
+	const struct object_mapping *map = object_mappings_index(mappings, GUINT_TO_POINTER(idx));
+	struct object_mapping_param *param = (struct object_mapping_param*)wmem_map_lookup(mappings->by_param, OBJECT_MAPPING_PARAM_KEY(map));
 
-	object->info.idx = idx;
+	if (!param)
+	{
+		param = wmem_new0(mappings->scope, struct object_mapping_param);
+		param->first = map->frame.first;
+		wmem_map_insert(mappings->by_param, OBJECT_MAPPING_PARAM_KEY(map), param);
+	}
+	else if (param->first > map->frame.first)
+	{
+		return;
+	}
+	else if (param->first < map->frame.first)
+	{
+		param->first = map->frame.first;
+		param->len = 0;
+	}
 
-	wmem_map_insert(profile->objects, &object->info.idx, object);
-	return object;
+	if (param->len == param->size)
+	{
+		param->size = param->size ? 2 * param->size : 1;
+		param->maps = (guint*)wmem_realloc(mappings->scope, param->maps, param->size * sizeof *param->maps);
+	}
+	param->maps[param->len++] = idx;
 }
 
-struct object *
-profile_object_lookup_or_add(struct profile *profile, guint16 idx)
+static void
+object_mappings_insert(struct object_mappings *mappings, guint idx)
 {
-	struct object *obj = object_lookup(profile, idx);
-	return obj ? obj : profile_object_add(profile, idx);
+	const struct object_mapping *map = object_mappings_index(mappings, GUINT_TO_POINTER(idx));
+
+	g_sequence_insert_sorted(mappings->order, GUINT_TO_POINTER(idx), object_mappings_order_cmp, mappings);
+	if (map->no_of_bits > mappings->max_bits)
+		mappings->max_bits = map->no_of_bits;
+	object_mappings_remember_param(mappings, idx);
 }
 
+static void object_mappings_unshare(struct object_mappings *mappings);
 
-gboolean
-profile_object_mapping_add(struct profile *profile, guint16 idx, guint8 subindex, guint64 mapping)
+static void
+object_mappings_append(struct object_mappings *dst, struct object_mappings *src)
 {
-	wmem_array_t *mappings;
-	tvbuff_t *tvb;
-	guint64 mapping_le;
+	guint i, base, len;
+	struct object_mapping *maps;
 
-	if (!read_xdc_for_mappings)
-		return FALSE;
+	object_mappings_unshare(dst);
 
-	if(idx == EPL_SOD_PDO_RX_MAPP && subindex >= 0x01 && subindex <= 0xfe)
-		mappings = profile->RPDO;
-	else if (idx == EPL_SOD_PDO_TX_MAPP && subindex >= 0x01 && subindex <= 0xfe)
-		mappings = profile->TPDO;
-	else
-		return FALSE;
+	maps = get_object_mappings(src, &len);
+	if (!len)
+		return;
 
-	mapping_le = GUINT64_TO_LE(mapping);
-	tvb = tvb_new_real_data((guint8*)&mapping_le, sizeof mapping_le, sizeof mapping_le);
+	base = wmem_array_get_count(dst->arr);
+	wmem_array_append(dst->arr, maps, len);
 
-	return dissect_object_mapping(profile, mappings, NULL, tvb, 0, 0, idx, subindex) == sizeof mapping;
-}
+	for (i = base; i < base + len; i++)
+		object_mappings_insert(dst, i);
 
-static struct subobject * subobject_lookup(struct object *obj, guint8 subindex);
+	object_mappings_invalidate(dst, 0);
+}
 
-gboolean
-profile_object_mappings_update(struct profile *profile)
+/* Takes a copy of the shared mappings before they are changed */
+static void
+object_mappings_unshare(struct object_mappings *mappings)
 {
-	gboolean updated_any = FALSE;
-	guint i, len;
-	struct object_mapping *mappings;
-	wmem_array_t *PDOs[3], **PDO;
+	struct object_mappings *shared = mappings->shared;
 
-	if (!read_xdc_for_mappings)
-		return FALSE;
+	if (!shared)
+		return;
 
+	mappings->shared = NULL;
+	object_mappings_append(mappings, shared);
+}
 
-	PDOs[0] = profile->RPDO;
-	PDOs[1] = profile->TPDO;
-	PDOs[2] = NULL;
+static void
+pdo_plan_entry_init(struct pdo_plan_entry *entry, const struct object_mapping *map)
+{
+	const struct epl_datatype *type = map->info ? map->info->type : NULL;
+
+	entry->first_frame  = map->frame.first;
+	entry->bit_offset   = map->bit_offset;
+	entry->no_of_bits   = map->no_of_bits;
+	entry->byte_len     = map->no_of_bits / 8;
+	entry->byte_offset  = map->bit_offset / 8;
+	entry->span_len     = (map->bit_offset % 8 + map->no_of_bits + 7) / 8;
+	entry->ett          = map->ett;
+	entry->title        = map->title;
+	entry->pdo.idx      = map->pdo.idx;
+	entry->pdo.subindex = map->pdo.subindex;
+	entry->param.idx    = map->param.idx;
+	entry->param.subindex = map->param.subindex;
+
+	entry->index_name    = map->info ? map->index_name : NULL;
+	entry->subindex_name = map->info && map->info->name != map->index_name
+	                     ? map->info->name : NULL;
+
+	/* Same check dissect_epl_payload does for every item */
+	if (type && (!type->len || type->len == entry->byte_len))
+	{
+		entry->hf       = *type->hf;
+		entry->encoding = type->encoding;
+	}
+	else
+	{
+		entry->hf       = -1;
+		entry->encoding = ENC_NA;
+	}
 
-	for (PDO = PDOs; *PDO; PDO++)
+	if (entry->bit_offset % 8 == 0 && entry->no_of_bits % 8 == 0)
+	{
+		entry->extract = PDO_EXTRACT_ALIGNED;
+	}
+	else if (entry->hf != -1)
+	{
+		/* Typed objects at an unaligned offset, e.g. an Integer16 at bit 4.
+		 * Integers and Booleans still get a kind below.
+		 */
+		entry->extract = PDO_EXTRACT_COPY;
+	}
+	else if (0 < entry->no_of_bits && entry->no_of_bits <= 64)
+	{
+		/* Bit fields are shown as the raw value, only single bit
+		 * Booleans keep their type
+		 */
+		gint *hf = SIZE_TO_UNSIGNED_HF((entry->no_of_bits + 7) / 8);
+
+		entry->extract  = PDO_EXTRACT_BITS;
+		entry->encoding = ENC_LITTLE_ENDIAN;
+		if (type && type->hf == &hf_epl_od_boolean && entry->no_of_bits == 1)
+			entry->hf = hf_epl_od_boolean;
+		else
+			entry->hf = *hf;
+	}
+	else
 	{
-		len = wmem_array_get_count(*PDO);
-		mappings = (struct object_mapping*)wmem_array_get_raw(*PDO);
+		entry->extract = PDO_EXTRACT_COPY;
+	}
 
-		for (i = 0; i < len; i++)
+	entry->kind = EPL_PDO_VALUE_NONE;
+	if (entry->extract == PDO_EXTRACT_BITS)
+	{
+		entry->kind = entry->hf == hf_epl_od_boolean
+		            ? EPL_PDO_VALUE_BOOLEAN : EPL_PDO_VALUE_UNSIGNED;
+	}
+	else if (entry->hf != -1 && 0 < entry->byte_len && entry->byte_len <= 8)
+	{
+		switch (proto_registrar_get_ftype(entry->hf))
 		{
-			struct object_mapping *map = &mappings[i];
-			struct object *mapping_obj;
-			struct subobject *mapping_subobj;
-
-			if (!(mapping_obj = object_lookup(profile, map->pdo.idx)))
-				continue;
-			map->info = &mapping_obj->info;
-			map->index_name = map->info->name;
-			updated_any = TRUE;
-			if (!(mapping_subobj = subobject_lookup(mapping_obj, map->pdo.subindex)))
-				continue;
-			map->info = &mapping_subobj->info;
+			case FT_UINT8: case FT_UINT16: case FT_UINT24: case FT_UINT32:
+			case FT_UINT40: case FT_UINT48: case FT_UINT56: case FT_UINT64:
+				entry->kind = EPL_PDO_VALUE_UNSIGNED;
+				break;
+			case FT_INT8: case FT_INT16: case FT_INT24: case FT_INT32:
+			case FT_INT40: case FT_INT48: case FT_INT56: case FT_INT64:
+				entry->kind = EPL_PDO_VALUE_SIGNED;
+				break;
+			case FT_BOOLEAN:
+				entry->kind = EPL_PDO_VALUE_BOOLEAN;
+				break;
+			default:
+				break;
 		}
 	}
-
-	return updated_any;
 }
 
+/* POWERLINK numbers bits LSB first within little endian data, so a field
+ * is the bytes it spans, loaded little endian, shifted right by its offset
+ * into the first byte and masked to its width. span holds up to 9 bytes.
+ */
+static guint64
+pdo_extract_bits(const guint8 *span, guint bit_shift, guint no_of_bits)
+{
+	guint64 val = 0;
+	guint i, span_len = (bit_shift + no_of_bits + 7) / 8;
 
-struct epl_convo {
-	guint8 CN;
-
-	guint16 DeviceType;
-	guint32 ResponseTime;
-	guint32 VendorId;
-	guint32 ProductCode;
-
+	for (i = 0; i < span_len && i < 8; i++)
+		val |= (guint64)span[i] << (8 * i);
+	val >>= bit_shift;
+	if (span_len > 8)
+		val |= (guint64)span[8] << (64 - bit_shift);
 
-	wmem_array_t *TPDO; /* CN->MN */
-	wmem_array_t *RPDO; /* MN->CN */
+	if (no_of_bits < 64)
+		val &= (G_GUINT64_CONSTANT(1) << no_of_bits) - 1;
 
-	struct profile *profile;
+	return val;
+}
 
-	guint32 last_frame;
-	guint8 next_read_req;
-	guint8 seq_send;
-	
-	struct read_req {
-		guint16 idx;
-		guint8 subindex;
+/* Unpacks all scalar objects of a PDO payload in a single pass over the
+ * payload bytes. Returns the number of plan entries that fit the payload.
+ */
+static guint
+pdo_unpack(tvbuff_t *payload_tvb, const struct pdo_epoch *epoch, struct epl_pdo_value *objs)
+{
+	guint i, len = tvb_captured_length(payload_tvb);
+	const guint8 *payload = tvb_get_ptr(payload_tvb, 0, len);
 
-		guint8 sendsequence;
+	for (i = 0; i < epoch->count; i++)
+	{
+		const struct pdo_plan_entry *entry = &epoch->entries[i];
+		struct epl_pdo_value *obj = &objs[i];
+		const guint8 *p = payload + entry->byte_offset;
+		guint64 val;
 
-		const char *index_name;
-		struct od_entry *info;
-	} read_reqs[4];
-	/* In lieu of allocating an unknown number of read requests, we'll keep a ring
-	 * buff of the 4 most recent ones and when a response comes we add them as packet
-	 * data
-	 */
-};
+		if ((guint)entry->bit_offset + entry->no_of_bits > len * 8)
+			break;
 
-static struct read_req *
-convo_read_req_get(struct epl_convo *convo, packet_info *pinfo, guint8 SendSequenceNumber)
-{
-	guint i;
-	guint32 seq_p_key = (ETHERTYPE_EPL_V2 << 16) | convo->seq_send;
-	struct read_req *req = (struct read_req*)p_get_proto_data(wmem_file_scope(), pinfo, proto_epl, seq_p_key);
+		obj->idx        = entry->pdo.idx;
+		obj->subindex   = entry->pdo.subindex;
+		obj->kind       = entry->kind;
+		obj->bit_offset = entry->bit_offset;
+		obj->no_of_bits = entry->no_of_bits;
+		obj->value      = 0;
 
-	if (req)
-		return req;
+		if (entry->kind == EPL_PDO_VALUE_NONE)
+			continue;
 
-	for (i = 0; i < array_length(convo->read_reqs); i++)
-	{
-		if(convo->read_reqs[i].sendsequence == SendSequenceNumber)
+		if (entry->extract != PDO_EXTRACT_ALIGNED)
+		{
+			val = pdo_extract_bits(p, entry->bit_offset % 8, entry->no_of_bits);
+		}
+		else switch (entry->byte_len)
 		{
-			req = wmem_new(wmem_file_scope(), struct read_req);
-			*req = convo->read_reqs[i];
-			p_add_proto_data(wmem_file_scope(), pinfo, proto_epl, seq_p_key, req);
-			return req;
+			case 1: val = *p;           break;
+			case 2: val = pletoh16(p);  break;
+			case 4: val = pletoh32(p);  break;
+			case 8: val = pletoh64(p);  break;
+			default: val = pdo_extract_bits(p, 0, entry->no_of_bits); break;
 		}
+
+		if (entry->kind == EPL_PDO_VALUE_SIGNED && entry->no_of_bits < 64
+		&& (val >> (entry->no_of_bits - 1)) & 1)
+			val |= ~G_GUINT64_CONSTANT(0) << entry->no_of_bits;
+
+		obj->value = val;
 	}
 
-	return NULL;
-}
-static struct read_req *
-convo_read_req_set(struct epl_convo *convo, guint8 SendSequenceNumber)
-{
-	struct read_req *slot = &convo->read_reqs[convo->next_read_req++];
-	convo->next_read_req %= array_length(convo->read_reqs);
-	slot->sendsequence = SendSequenceNumber;
-	return slot;
+	return i;
 }
 
+static void
+pdo_add_value(proto_tree *tree, const struct pdo_plan_entry *entry, tvbuff_t *payload_tvb, guint64 val)
+{
+	gint len = entry->extract != PDO_EXTRACT_ALIGNED ? entry->span_len : entry->byte_len;
 
-static int
+	switch (entry->kind)
+	{
+		case EPL_PDO_VALUE_UNSIGNED:
+			if (entry->no_of_bits <= 32)
+				proto_tree_add_uint(tree, entry->hf, payload_tvb, entry->byte_offset, len, (guint32)val);
+			else
+				proto_tree_add_uint64(tree, entry->hf, payload_tvb, entry->byte_offset, len, val);
+			break;
+		case EPL_PDO_VALUE_SIGNED:
+			if (entry->no_of_bits <= 32)
+				proto_tree_add_int(tree, entry->hf, payload_tvb, entry->byte_offset, len, (gint32)val);
+			else
+				proto_tree_add_int64(tree, entry->hf, payload_tvb, entry->byte_offset, len, (gint64)val);
+			break;
+		case EPL_PDO_VALUE_BOOLEAN:
+			proto_tree_add_boolean(tree, entry->hf, payload_tvb, entry->byte_offset, len, (guint32)val);
+			break;
+	}
+}
+
+/* The frame from which on a mapping is or stops being active */
+struct pdo_plan_event {
+	guint32 framenum;
+	guint map;
+	gboolean start;
+};
+
+static int
+pdo_plan_event_cmp(const void *_a, const void *_b)
+{
+	const struct pdo_plan_event *a = (const struct pdo_plan_event*)_a;
+	const struct pdo_plan_event *b = (const struct pdo_plan_event*)_b;
+
+	if (a->framenum < b->framenum) return -1;
+	if (a->framenum > b->framenum) return +1;
+	return 0;
+}
+
+/* Index of the first active map not before map */
+static guint
+pdo_plan_active_pos(const guint *active, guint nactive, guint map)
+{
+	guint low = 0, high = nactive;
+
+	while (low < high)
+	{
+		guint mid = low + (high - low) / 2;
+		if (active[mid] < map)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+static void
+object_mappings_add_epoch(struct object_mappings *mappings, guint32 first, guint32 last, const struct object_mapping *maps, const guint *sorted, const guint *active, guint nactive)
+{
+	struct pdo_plan_entry *entries;
+	struct pdo_epoch *epoch;
+	guint i;
+
+	if (mappings->epochs_len == mappings->epochs_size)
+	{
+		mappings->epochs_size = mappings->epochs_size ? 2 * mappings->epochs_size : 8;
+		mappings->epochs = (struct pdo_epoch*)wmem_realloc(mappings->scope, mappings->epochs,
+				mappings->epochs_size * sizeof *mappings->epochs);
+	}
+
+	entries = wmem_alloc_array(mappings->scope, struct pdo_plan_entry, nactive);
+	for (i = 0; i < nactive; i++)
+	{
+		pdo_plan_entry_init(&entries[i], &maps[sorted[active[i]]]);
+		entries[i].map = sorted[active[i]];
+	}
+
+	epoch = &mappings->epochs[mappings->epochs_len++];
+	epoch->first   = first;
+	epoch->last    = last;
+	epoch->entries = entries;
+	epoch->count   = nactive;
+}
+
+/* Builds the epochs from stale_from on in one sweep over the frames at
+ * which mappings start or stop being active, keeping the active set
+ */
+static void
+object_mappings_compile(struct object_mappings *mappings)
+{
+	guint i, pos, maps_count, nevents = 0, nactive = 0;
+	guint32 from = mappings->stale_from;
+	struct object_mapping *maps;
+	struct pdo_plan_event *events;
+	guint *sorted, *active;
+	GSequenceIter *it;
+
+	mappings->stale_from = G_MAXUINT32;
+
+	/* Epochs before from are still right, the last one may end earlier now */
+	while (mappings->epochs_len && mappings->epochs[mappings->epochs_len - 1].first >= from)
+	{
+		mappings->epochs_len--;
+		wmem_free(mappings->scope, (void*)mappings->epochs[mappings->epochs_len].entries);
+	}
+	if (mappings->epochs_len && mappings->epochs[mappings->epochs_len - 1].last > from)
+		mappings->epochs[mappings->epochs_len - 1].last = from;
+
+	maps = get_object_mappings(mappings, &maps_count);
+	if (!maps_count)
+		return;
+
+	/* Events refer to a mapping by its rank in order */
+	sorted = g_new(guint, maps_count);
+	for (i = 0, it = g_sequence_get_begin_iter(mappings->order); i < maps_count; i++, it = g_sequence_iter_next(it))
+		sorted[i] = GPOINTER_TO_UINT(g_sequence_get(it));
+
+	/* A mapping is active for first < framenum < last */
+	events = g_new(struct pdo_plan_event, 2 * maps_count);
+	for (i = 0; i < maps_count; i++)
+	{
+		const struct object_mapping *map = &maps[sorted[i]];
+		guint32 first = MAX(map->frame.first + 1, from);
+
+		if (first >= map->frame.last)
+			continue;
+
+		events[nevents].framenum = first;
+		events[nevents].map = i;
+		events[nevents++].start = TRUE;
+		events[nevents].framenum = map->frame.last;
+		events[nevents].map = i;
+		events[nevents++].start = FALSE;
+	}
+	qsort(events, nevents, sizeof *events, pdo_plan_event_cmp);
+
+	/* order is sorted by bit_offset, so active ranks in ascending order
+	 * keep the entries sorted, too
+	 */
+	active = g_new(guint, maps_count);
+	for (i = 0; i < nevents; )
+	{
+		guint32 framenum = events[i].framenum;
+
+		for (; i < nevents && events[i].framenum == framenum; i++)
+		{
+			pos = pdo_plan_active_pos(active, nactive, events[i].map);
+			if (events[i].start)
+			{
+				memmove(&active[pos + 1], &active[pos], (nactive - pos) * sizeof *active);
+				active[pos] = events[i].map;
+				nactive++;
+			}
+			else if (pos < nactive && active[pos] == events[i].map)
+			{
+				nactive--;
+				memmove(&active[pos], &active[pos + 1], (nactive - pos) * sizeof *active);
+			}
+		}
+
+		/* every active mapping still has its end ahead */
+		if (nactive && i < nevents)
+			object_mappings_add_epoch(mappings, framenum, events[i].framenum, maps, sorted, active, nactive);
+	}
+
+	g_free(sorted);
+	g_free(active);
+	g_free(events);
+}
+
+/* Returns the epoch holding the plan for framenum or NULL if no mapping applies */
+static const struct pdo_epoch *
+object_mappings_get_epoch(struct object_mappings *mappings, guint32 framenum)
+{
+	guint low = 0, high;
+
+	mappings = OBJECT_MAPPINGS_RESOLVE(mappings);
+	if (mappings->stale_from != G_MAXUINT32)
+		object_mappings_compile(mappings);
+
+	high = mappings->epochs_len;
+	while (low < high)
+	{
+		guint mid = low + (high - low) / 2;
+		const struct pdo_epoch *epoch = &mappings->epochs[mid];
+
+		if (framenum < epoch->first)
+			high = mid;
+		else if (framenum >= epoch->last)
+			low = mid + 1;
+		else
+			return epoch;
+	}
+
+	return NULL;
+}
+
+/* Ends map's life time with framenum */
+static void
+object_mapping_end(struct object_mappings *mappings, struct object_mapping *map, guint32 framenum)
+{
+	object_mappings_invalidate(mappings, MIN(map->frame.last, framenum));
+	map->frame.last = framenum;
+}
+
+static guint
+add_object_mapping(struct object_mappings *mappings, struct object_mapping *mapping)
+{
+	guint i, len;
+	guint16 window;
+	struct object_mapping_param *param;
+	GSequenceIter *it;
+	struct object_mapping *map;
+
+	object_mappings_unshare(mappings);
+	len = wmem_array_get_count(mappings->arr);
+
+	/* Dissecting the same write again mustn't add its mapping twice */
+	for (it = object_mappings_lower_bound(mappings, mapping->bit_offset, mapping->frame.first);
+	     (map = object_mappings_iter_get(mappings, it)) && object_mapping_pos_cmp(map, mapping->bit_offset, mapping->frame.first) == 0;
+	     it = g_sequence_iter_next(it))
+	{
+		if (object_mapping_eq(map, mapping))
+			return len;
+	}
+
+	/* let's check if this overwrites an existing mapping */
+	window = mapping->bit_offset > mappings->max_bits ? mapping->bit_offset - mappings->max_bits : 0;
+	for (it = object_mappings_lower_bound(mappings, window, 0);
+	     (map = object_mappings_iter_get(mappings, it)) && map->bit_offset < mapping->bit_offset + mapping->no_of_bits;
+	     it = g_sequence_iter_next(it))
+	{
+		if (map->frame.first < mapping->frame.first
+		&&  CHECK_OVERLAP_LENGTH(map->bit_offset, map->no_of_bits, mapping->bit_offset, mapping->no_of_bits))
+		{
+			object_mapping_end(mappings, map, mapping->frame.first);
+		}
+	}
+
+	/* or if it's written by the same ObjectMapping parameter */
+	param = (struct object_mapping_param*)wmem_map_lookup(mappings->by_param, OBJECT_MAPPING_PARAM_KEY(mapping));
+	if (param && param->first < mapping->frame.first)
+	{
+		for (i = 0; i < param->len; i++)
+		{
+			map = object_mappings_index(mappings, GUINT_TO_POINTER(param->maps[i]));
+			if (CHECK_OVERLAP_ENDS(map->frame.first, map->frame.last, mapping->frame.first, mapping->frame.last))
+				object_mapping_end(mappings, map, mapping->frame.first);
+		}
+	}
+
+	wmem_array_append(mappings->arr, mapping, 1);
+	object_mappings_insert(mappings, len);
+
+	object_mappings_invalidate(mappings, mapping->frame.first + 1);
+	return len + 1;
+}
+
+static wmem_map_t *epl_profiles_by_device, *epl_profiles_by_nodeid, *epl_profiles_by_address;
+static wmem_map_t *epl_profiles_by_file; /* parsed profiles by canonical path */
+static struct profile *epl_default_profile;
+const char *epl_default_profile_path;
+
+static gboolean
+profile_del_cb(wmem_allocator_t *pool _U_, wmem_cb_event_t event _U_, void *_profile)
+{
+	struct profile *profile = (struct profile*)_profile;
+	if (profile->parent_map)
+		wmem_map_remove(profile->parent_map, profile->data);
+	wmem_destroy_allocator(profile->scope);
+	return FALSE;
+}
+
+static void
+profile_unref(struct profile *profile)
+{
+	if (--profile->refcount)
+		return;
+
+	/* a changed file may have been registered anew meanwhile */
+	if (profile->file && wmem_map_lookup(epl_profiles_by_file, profile->file) == profile)
+		wmem_map_remove(epl_profiles_by_file, profile->file);
+
+	wmem_unregister_callback(profile->parent_scope, profile->cb_id);
+	profile_del_cb(NULL, WMEM_CB_DESTROY_EVENT, profile);
+}
+
+static void
+profile_del(struct profile *profile)
+{
+	if (!profile) return;
+
+	if (profile->shared)
+	{
+		if (profile->parent_map)
+			wmem_map_remove(profile->parent_map, profile->data);
+		free_address_wmem(profile->scope, &profile->node_addr);
+		profile_unref(profile->shared);
+		wmem_free(profile->scope, profile);
+		return;
+	}
+
+	wmem_unregister_callback(profile->parent_scope, profile->cb_id);
+	profile_del_cb(NULL, WMEM_CB_DESTROY_EVENT, profile);
+}
+
+/* A UAT row's handle on a parsed profile */
+static struct profile *
+profile_ref(wmem_allocator_t *parent_pool, struct profile *shared)
+{
+	struct profile *profile = wmem_new(parent_pool, struct profile);
+
+	*profile = *shared;
+	profile->scope        = parent_pool;
+	profile->parent_scope = parent_pool;
+	profile->parent_map   = NULL;
+	profile->data         = NULL;
+	profile->cb_id        = 0;
+	profile->next         = NULL;
+	profile->shared       = shared;
+	profile->refcount     = 0;
+	profile->file         = NULL;
+	clear_address(&profile->node_addr);
+
+	shared->refcount++;
+	return profile;
+}
+
+static struct profile *
+profile_new(wmem_allocator_t *parent_pool)
+{
+	wmem_allocator_t *pool;
+	struct profile *profile;
+	
+	pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+	profile = wmem_new0(pool, struct profile);
+	profile->cb_id = wmem_register_callback(parent_pool, profile_del_cb, profile);
+
+	profile->scope        = pool;
+	profile->parent_scope = parent_pool;
+	profile->parent_map   = NULL;
+	profile->objects      = wmem_map_new(pool, epl_g_int16_hash, epl_g_int16_equal);
+	profile->name         = NULL;
+	profile->path         = NULL;
+	profile->RPDO         = object_mappings_new(pool);
+	profile->TPDO         = object_mappings_new(pool);
+	profile->default_mappings = wmem_array_new(pool, sizeof (struct profile_mapping));
+	profile->next         = NULL;
+
+	return profile;
+}
+
+struct object *
+profile_object_add(struct profile *profile, guint16 idx)
+{
+	struct object *object = wmem_new0(profile->scope, struct object);
+
+	object->info.idx = idx;
+
+	wmem_map_insert(profile->objects, &object->info.idx, object);
+	return object;
+}
+
+struct object *
+profile_object_lookup_or_add(struct profile *profile, guint16 idx)
+{
+	struct object *obj = object_lookup(profile, idx);
+	return obj ? obj : profile_object_add(profile, idx);
+}
+
+
+/* Only records the mapping, parsers may run off the main thread.
+ * profile_object_mappings_build() turns them into PDO mappings later
+ */
+gboolean
+profile_object_mapping_add(struct profile *profile, guint16 idx, guint8 subindex, guint64 mapping)
+{
+	struct profile_mapping raw;
+
+	if (idx != EPL_SOD_PDO_RX_MAPP && idx != EPL_SOD_PDO_TX_MAPP)
+		return FALSE;
+	if (subindex < 0x01 || subindex > 0xfe)
+		return FALSE;
+
+	/* remembered regardless of the preference, so cached profiles have them */
+	raw.idx = idx;
+	raw.subindex = subindex;
+	raw.value = mapping;
+	wmem_array_append_one(profile->default_mappings, raw);
+
+	return read_xdc_for_mappings;
+}
+
+static struct subobject * subobject_lookup(struct object *obj, guint8 subindex);
+
+gboolean
+profile_object_mappings_update(struct profile *profile)
+{
+	gboolean updated_any = FALSE;
+	guint i, len;
+	struct object_mapping *mappings;
+	struct object_mappings *PDOs[3], **PDO;
+
+	if (!read_xdc_for_mappings)
+		return FALSE;
+
+
+	PDOs[0] = profile->RPDO;
+	PDOs[1] = profile->TPDO;
+	PDOs[2] = NULL;
+
+	for (PDO = PDOs; *PDO; PDO++)
+	{
+		mappings = get_object_mappings(*PDO, &len);
+		object_mappings_invalidate(*PDO, 0);
+
+		for (i = 0; i < len; i++)
+		{
+			struct object_mapping *map = &mappings[i];
+			struct object *mapping_obj;
+			struct subobject *mapping_subobj;
+
+			if (!(mapping_obj = object_lookup(profile, map->pdo.idx)))
+				continue;
+			map->info = &mapping_obj->info;
+			map->index_name = map->info->name;
+			updated_any = TRUE;
+			if (!(mapping_subobj = subobject_lookup(mapping_obj, map->pdo.subindex)))
+				continue;
+			map->info = &mapping_subobj->info;
+		}
+	}
+
+	return updated_any;
+}
+
+/* Mappings are built once the whole profile is read, so all mapped
+ * objects can be referenced. This registers PDO subtrees, so it must
+ * run on the main thread
+ */
+static void
+profile_object_mappings_build(struct profile *profile)
+{
+	const struct profile_mapping *raw;
+	tvbuff_t *tvb;
+	guint64 mapping_le;
+	guint i, count;
+
+	if (!read_xdc_for_mappings)
+		return;
+
+	count = wmem_array_get_count(profile->default_mappings);
+	for (i = 0; i < count; i++)
+	{
+		raw = (const struct profile_mapping*)wmem_array_index(profile->default_mappings, i);
+
+		mapping_le = GUINT64_TO_LE(raw->value);
+		tvb = tvb_new_real_data((guint8*)&mapping_le, sizeof mapping_le, sizeof mapping_le);
+		dissect_object_mapping(profile, raw->idx == EPL_SOD_PDO_RX_MAPP ? profile->RPDO : profile->TPDO,
+				NULL, tvb, 0, 0, raw->idx, raw->subindex);
+		tvb_free(tvb);
+	}
+
+	profile_object_mappings_update(profile);
+}
+
+
+struct read_req {
+	guint16 idx;
+	guint8 subindex;
+
+	guint8 sendsequence;
+
+	const char *index_name;
+	struct od_entry *info;
+};
+
+struct epl_convo {
+	guint8 CN;
+
+	guint16 DeviceType;
+	guint32 ResponseTime;
+	guint32 VendorId;
+	guint32 ProductCode;
+
+
+	struct object_mappings *TPDO; /* CN->MN */
+	struct object_mappings *RPDO; /* MN->CN */
+
+	struct profile *profile;
+
+	guint32 last_frame;
+	guint8 seq_send;
+	guint8 transaction_id;
+
+	/* Read requests waiting for their response, keyed by transaction id.
+	 * The response takes its request out of here and keeps it as packet
+	 * data, so there are never more than 256 of them
+	 */
+	wmem_map_t *read_reqs;
+};
+
+#define EPL_SDO_READ_REQ_KEY 2
+
+static struct read_req *
+convo_read_req_get(struct epl_convo *convo, packet_info *pinfo, guint8 TransactionId, gboolean complete)
+{
+	struct read_req *req = (struct read_req*)p_get_proto_data(wmem_file_scope(), pinfo, proto_epl, EPL_SDO_READ_REQ_KEY);
+
+	if (req || PINFO_FD_VISITED(pinfo))
+		return req;
+
+	req = (struct read_req*)wmem_map_lookup(convo->read_reqs, GUINT_TO_POINTER(TransactionId));
+	if (!req)
+		return NULL;
+
+	if (complete)
+		wmem_map_remove(convo->read_reqs, GUINT_TO_POINTER(TransactionId));
+	p_add_proto_data(wmem_file_scope(), pinfo, proto_epl, EPL_SDO_READ_REQ_KEY, req);
+
+	return req;
+}
+
+/* Returns NULL when the request was registered on an earlier pass */
+static struct read_req *
+convo_read_req_set(struct epl_convo *convo, packet_info *pinfo, guint8 TransactionId, guint8 SendSequenceNumber)
+{
+	struct read_req *req;
+
+	if (PINFO_FD_VISITED(pinfo))
+		return NULL;
+
+	req = wmem_new0(wmem_file_scope(), struct read_req);
+	req->sendsequence = SendSequenceNumber;
+	wmem_map_insert(convo->read_reqs, GUINT_TO_POINTER(TransactionId), req);
+
+	return req;
+}
+
+
+#define EPL_PDO_VALUES_KEY 1
+
+const struct epl_pdo_values *
+epl_get_pdo_values(packet_info *pinfo)
+{
+	return (const struct epl_pdo_values*)p_get_proto_data(pinfo->pool, pinfo, proto_epl, EPL_PDO_VALUES_KEY);
+}
+
+static int
 dissect_epl_pdo(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, guint offset, guint len, guint8 msgType)
 {
-	wmem_array_t *mapping = msgType == EPL_PRES ? convo->TPDO : convo->RPDO;
+	struct object_mappings *mappings = msgType == EPL_PRES ? convo->TPDO : convo->RPDO;
+	const struct pdo_epoch *epoch;
+	struct epl_pdo_values *values;
 	tvbuff_t *payload_tvb;
-	guint rem_len, rem_len_bits;
-	guint i, maps_count;
+	guint rem_len;
+	guint i;
 	guint off = 0;
+	gboolean add_all;
 
-	struct object_mapping *mappings = get_object_mappings(mapping, &maps_count);
+	epoch = object_mappings_get_epoch(mappings, pinfo->num);
 
 	rem_len = tvb_captured_length_remaining(tvb, offset);
 	payload_tvb = tvb_new_subset_length(tvb, offset, len > rem_len ? rem_len : len);
 	rem_len = tvb_captured_length_remaining(payload_tvb, 0);
-	rem_len_bits = rem_len * 8;
 
+	values = wmem_new0(pinfo->pool, struct epl_pdo_values);
+	values->msgType = msgType;
+	if (epoch && epoch->count)
+	{
+		values->objs = wmem_alloc_array(pinfo->pool, struct epl_pdo_value, epoch->count);
+		values->count = pdo_unpack(payload_tvb, epoch, values->objs);
+	}
+	p_add_proto_data(pinfo->pool, pinfo, proto_epl, EPL_PDO_VALUES_KEY, values);
 
-	for (i = 0; i < maps_count; i++)
+	/* A tree that is only there for a display filter needn't get
+	 * the objects whose fields the filter doesn't refer to.
+	 * For visible trees, all fields count as referenced.
+	 */
+	add_all = proto_field_is_referenced(epl_tree, proto_epl)
+	       || proto_field_is_referenced(epl_tree, hf_epl_pdo)
+	       || proto_field_is_referenced(epl_tree, hf_epl_pdo_index)
+	       || proto_field_is_referenced(epl_tree, hf_epl_pdo_subindex)
+	       || (show_pdo_meta_info && proto_field_is_referenced(epl_tree, hf_epl_asnd_identresponse_profile_path));
+
+	for (i = 0; i < values->count; i++)
 	{
 		proto_tree *pdo_tree;
 		proto_item *psf_item, *ti;
-		struct object_mapping *map = &mappings[i];
-		guint willbe_offset_bits = map->bit_offset + map->no_of_bits;
+		tvbuff_t *obj_tvb;
+		const struct pdo_plan_entry *entry = &epoch->entries[i];
+
+		off = (entry->bit_offset + entry->no_of_bits) / 8;
 
-		if (!(map->frame.first < pinfo->num && pinfo->num < map->frame.last))
+		/* Without a tree, the values are already unpacked for the taps and
+		 * only objects of unknown type are left for heuristic dissectors
+		 */
+		if (!epl_tree)
+		{
+			if (entry->hf == -1 && entry->extract == PDO_EXTRACT_ALIGNED)
+				dissect_epl_payload(NULL, payload_tvb, pinfo, entry->byte_offset, entry->byte_len, NULL, msgType);
 			continue;
+		}
 
-		if (willbe_offset_bits > rem_len_bits)
-			break;
+		if (!add_all && entry->hf != -1 && !proto_field_is_referenced(epl_tree, entry->hf))
+			continue;
 
-		psf_item = proto_tree_add_string_format(epl_tree, hf_epl_pdo, payload_tvb, 0, 0, "", "%s", map->title);
-		pdo_tree = proto_item_add_subtree(psf_item, map->ett);
+		psf_item = proto_tree_add_string_format(epl_tree, hf_epl_pdo, payload_tvb, 0, 0, "", "%s", entry->title);
+		pdo_tree = proto_item_add_subtree(psf_item, entry->ett);
 
-		ti = proto_tree_add_uint_format_value(pdo_tree, hf_epl_pdo_index, payload_tvb, 0, 0, map->pdo.idx, "%04X", map->pdo.idx);
+		ti = proto_tree_add_uint_format_value(pdo_tree, hf_epl_pdo_index, payload_tvb, 0, 0, entry->pdo.idx, "%04X", entry->pdo.idx);
 		PROTO_ITEM_SET_GENERATED(ti);
-		if (map->info)
-			proto_item_append_text (ti, " (%s)", map->index_name);
+		if (entry->index_name)
+			proto_item_append_text (ti, " (%s)", entry->index_name);
 
-		ti = proto_tree_add_uint_format_value(pdo_tree, hf_epl_pdo_subindex, payload_tvb, 0, 0, map->pdo.subindex, "%02X", map->pdo.subindex);
+		ti = proto_tree_add_uint_format_value(pdo_tree, hf_epl_pdo_subindex, payload_tvb, 0, 0, entry->pdo.subindex, "%02X", entry->pdo.subindex);
 		PROTO_ITEM_SET_GENERATED(ti);
 
-		if (map->info && map->info->name != map->index_name)
-			proto_item_append_text (ti, " (%s)", map->info->name);
+		if (entry->subindex_name)
+			proto_item_append_text (ti, " (%s)", entry->subindex_name);
 
 		if (show_pdo_meta_info)
 		{
 			ti = proto_tree_add_string_format(pdo_tree, hf_epl_asnd_identresponse_profile_path, tvb, 0, 0,
 					"", "Mapping set by %04X:%02X, Life time: Frame #%u-#%u, Offset: 0x%04x, Length %u bits",
-					map->param.idx, map->param.subindex, map->frame.first, map->frame.last, map->bit_offset, map->no_of_bits
+					entry->param.idx, entry->param.subindex, entry->first_frame, object_mappings_last_frame(mappings, entry), entry->bit_offset, entry->no_of_bits
 					);
 			PROTO_ITEM_SET_GENERATED(ti);
 		}
 
-		dissect_epl_payload(
-				pdo_tree,
-				tvb_new_octet_aligned(payload_tvb, map->bit_offset, map->no_of_bits),
-				pinfo, 0, map->no_of_bits / 8, map->info ? map->info->type : NULL, msgType
-		); 
-
-		off = willbe_offset_bits / 8;
+		/* Scalars are added from their unpacked value, with their type's
+		 * field even if they are unaligned
+		 */
+		if (entry->kind != EPL_PDO_VALUE_NONE)
+		{
+			pdo_add_value(pdo_tree, entry, payload_tvb, values->objs[i].value);
+		}
+		else if (entry->extract == PDO_EXTRACT_ALIGNED)
+		{
+			if (entry->hf != -1)
+				proto_tree_add_item(pdo_tree, entry->hf, payload_tvb, entry->byte_offset, entry->byte_len, entry->encoding);
+			else
+				dissect_epl_payload(pdo_tree, payload_tvb, pinfo, entry->byte_offset, entry->byte_len, NULL, msgType);
+		}
+		else
+		{
+			obj_tvb = tvb_new_octet_aligned(payload_tvb, entry->bit_offset, entry->no_of_bits);
+			if (entry->hf != -1)
+				proto_tree_add_item(pdo_tree, entry->hf, obj_tvb, 0, entry->byte_len, entry->encoding);
+			else
+				dissect_epl_payload(pdo_tree, obj_tvb, pinfo, 0, entry->byte_len, NULL, msgType);
+		}
 	}
 
 	/* If we don't have more information, resort to data dissector */
@@ -2039,6 +2875,86 @@ dissect_epl_pdo(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, pa
 
 enum convo_opts { CONVO_FOR_RESPONSE = 1, CONVO_FOR_REQUEST = 2, CONVO_ALWAYS_CREATE = 4 };
 
+/* Node state of EPL over Ethernet, directly indexed by node id instead
+ * of going through epan's conversations on every PReq/PRes.
+ * Each slot lists the node's generations, newest first. A generation
+ * applies from the frame that started it (the first frame seen from the
+ * node or an IdentResponse) until the next one starts, so re-dissected
+ * frames find the state they were first dissected with.
+ * EPL over UDP still uses epan conversations keyed by IP address.
+ */
+struct epl_node_convo {
+	guint32 first_frame, last_frame;
+	address addr;
+	struct epl_convo *convo;
+	struct epl_node_convo *prev; /* older generation */
+};
+
+static struct epl_convo *
+epl_convo_new(struct epl_capture *capture, guint32 node_port, address *node_dl_addr)
+{
+	struct epl_convo *convo = wmem_new0(wmem_file_scope(), struct epl_convo);
+
+	convo->CN = (guint8)node_port;
+	convo->TPDO = object_mappings_new(capture->pdo_mapping_scope);
+	convo->RPDO = object_mappings_new(capture->pdo_mapping_scope);
+
+	convo->profile = (struct profile*)wmem_map_lookup(epl_profiles_by_address, node_dl_addr);
+	if (!convo->profile)
+		convo->profile = (struct profile*)wmem_map_lookup(epl_profiles_by_nodeid, &convo->CN);
+
+	if (!convo->profile)
+		convo->profile = epl_default_profile;
+
+	convo->seq_send = 0x00;
+	convo->read_reqs = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+
+	return convo;
+}
+
+static struct epl_convo *
+epl_get_node_convo(packet_info *pinfo, enum convo_opts opts, guint32 node_port, address *node_addr, address *node_dl_addr)
+{
+	struct epl_capture *capture = epl_capture_get(pinfo);
+	struct epl_node_convo **slot = &capture->node_convos[node_port & 0xFF];
+	struct epl_node_convo *gen;
+	guint32 last_frame = 0;
+
+	for (gen = *slot; gen; gen = gen->prev)
+	{
+		if (gen->first_frame <= pinfo->num && addresses_equal(&gen->addr, node_addr))
+			break;
+	}
+
+	/* An IdentResponse starts a new generation, unless it already did
+	 * when it was dissected before
+	 */
+	if (gen && (opts & CONVO_ALWAYS_CREATE) && gen->first_frame != pinfo->num)
+		gen = NULL;
+
+	if (gen)
+	{
+		last_frame = gen->last_frame;
+		if (pinfo->num > gen->last_frame)
+			gen->last_frame = pinfo->num;
+	}
+	else
+	{
+		gen = wmem_new0(wmem_file_scope(), struct epl_node_convo);
+		gen->first_frame = gen->last_frame = pinfo->num;
+		copy_address_wmem(wmem_file_scope(), &gen->addr, node_addr);
+		gen->convo = epl_convo_new(capture, node_port, node_dl_addr);
+
+		while (*slot && (*slot)->first_frame > pinfo->num)
+			slot = &(*slot)->prev;
+		gen->prev = *slot;
+		*slot = gen;
+	}
+
+	gen->convo->last_frame = last_frame;
+	return gen->convo;
+}
+
 static struct epl_convo *
 epl_get_convo(packet_info *pinfo, enum convo_opts opts)
 {
@@ -2062,6 +2978,9 @@ epl_get_convo(packet_info *pinfo, enum convo_opts opts)
 		node_dl_addr = &pinfo->dl_src;
 	}
 
+	if (node_addr->type == AT_ETHER)
+		return epl_get_node_convo(pinfo, opts, node_port, node_addr, node_dl_addr);
+
 	if (!(opts & CONVO_ALWAYS_CREATE)
 	&& (epan_convo = find_conversation(pinfo->num, node_addr, node_addr, pinfo->ptype,
 					node_port, node_port, NO_ADDR_B|NO_PORT_B)))
@@ -2078,19 +2997,7 @@ epl_get_convo(packet_info *pinfo, enum convo_opts opts)
 
 	if (convo == NULL)
 	{
-		convo = wmem_new0(wmem_file_scope(), struct epl_convo);
-		convo->CN = (guint8)node_port;
-		convo->TPDO = wmem_array_new(pdo_mapping_scope, sizeof (struct object_mapping));
-		convo->RPDO = wmem_array_new(pdo_mapping_scope, sizeof (struct object_mapping));
-
-		convo->profile = (struct profile*)wmem_map_lookup(epl_profiles_by_address, node_dl_addr);
-		if (!convo->profile)
-			convo->profile = (struct profile*)wmem_map_lookup(epl_profiles_by_nodeid, &convo->CN);
-
-		if (!convo->profile)
-			convo->profile = epl_default_profile;
-
-		convo->seq_send = 0x00;
+		convo = epl_convo_new(epl_capture_get(pinfo), node_port, node_dl_addr);
 		conversation_add_proto_data(epan_convo, proto_epl, (void *)convo);
 	}
 	convo->last_frame = last_frame;
@@ -2118,32 +3025,38 @@ epl_update_convo_cn_profile(struct epl_convo *convo)
 
 		convo->profile = candidate;
 
-		if (!wmem_array_get_count(convo->RPDO))
-		{
-			wmem_array_append(convo->RPDO,
-				wmem_array_get_raw(candidate->RPDO),
-				wmem_array_get_count(candidate->RPDO)
-			);
-		}
-		if (!wmem_array_get_count(convo->TPDO))
-		{
-			wmem_array_append(convo->TPDO,
-				wmem_array_get_raw(candidate->TPDO),
-				wmem_array_get_count(candidate->TPDO)
-			);
-		}
+		if (!object_mappings_count(convo->RPDO))
+			object_mappings_share(convo->RPDO, candidate->RPDO);
+		if (!object_mappings_count(convo->TPDO))
+			object_mappings_share(convo->TPDO, candidate->TPDO);
 		return TRUE;
 	}
 	return FALSE;
 }
 
+G_LOCK_DEFINE_STATIC(epl_profile_objects);
+
 struct object *
 object_lookup(struct profile *profile, guint16 idx)
 {
+	struct object *obj;
+
 	if (profile == NULL)
 		return NULL;
 
-	return (struct object*)wmem_map_lookup(profile->objects, &idx);
+	/* Objects of a cached profile are built on first use, by whichever
+	 * session gets there first. Other profiles don't change once loaded
+	 */
+	if (!profile->cache)
+		return (struct object*)wmem_map_lookup(profile->objects, &idx);
+
+	G_LOCK(epl_profile_objects);
+	obj = (struct object*)wmem_map_lookup(profile->objects, &idx);
+	if (!obj)
+		obj = profile_cache_object(profile->cache, idx);
+	G_UNLOCK(epl_profile_objects);
+
+	return obj;
 }
 
 gboolean
@@ -2163,161 +3076,146 @@ subobject_lookup(struct object *obj, guint8 subindex)
 	return (struct subobject*)epl_wmem_iarray_find(obj->subindices, subindex);
 }
 
-static GHashTable *epl_duplication_table = NULL;
-
-/* epl duplication table hash function */
-static guint
-epl_duplication_hash(gconstpointer k)
+static void
+sdo_seq_frames_init(struct sdo_seq_frames *frames)
 {
-	const duplication_key *key = (const duplication_key*)k;
-	guint hash;
-
-	hash = ((key->src)<<24) | ((key->dest)<<16)|
-		((key->seq_recv)<<8)|(key->seq_send);
-
-	return hash;
+	/* generation 0 marks never written slots */
+	frames->generation = 1;
 }
 
-/* epl duplication table equal function */
-static gint
-epl_duplication_equal(gconstpointer k1, gconstpointer k2)
+/* invalidates all entries at once */
+static void
+sdo_seq_frames_reset(struct sdo_seq_frames *frames)
 {
-	const duplication_key *key1 = (const duplication_key*)k1;
-	const duplication_key *key2 = (const duplication_key*)k2;
-	gint hash;
-
-	hash = (key1->src == key2->src)&&(key1->dest == key2->dest)&&
-		(key1->seq_recv == key2->seq_recv)&&(key1->seq_send == key2->seq_send);
-
-	return hash;
+	if (++frames->generation == 0)
+	{ /* wrapped around, stale slots could look valid again */
+		memset(frames->slots, 0, sizeof frames->slots);
+		frames->generation = 1;
+	}
 }
 
-/* free the permanent key */
 static void
-free_key(gpointer ptr)
+sdo_seq_frames_set(struct sdo_seq_frames *frames, guint8 seq_recv, guint8 seq_send, guint32 frame)
 {
-	duplication_key *key = (duplication_key *)ptr;
-
-	if(key)
-		g_slice_free(duplication_key, key);
+	struct sdo_seq_frames_slot *slot = &frames->slots[seq_recv][seq_send];
+	slot->frame = frame;
+	slot->generation = frames->generation;
 }
 
-/* removes the table entries of a specific transfer */
-static void
-epl_duplication_remove(GHashTable* table, guint8 src, guint8 dest)
+/* get the saved frame */
+static guint32
+sdo_seq_frames_get(const struct sdo_seq_frames *frames, guint8 seq_recv, guint8 seq_send)
 {
-	GHashTableIter iter;
-	gpointer pkey, pvalue;
-	duplication_key *key;
+	const struct sdo_seq_frames_slot *slot = &frames->slots[seq_recv][seq_send];
+	return slot->generation == frames->generation ? slot->frame : 0x00;
+}
 
-	g_hash_table_iter_init(&iter, table);
+#define SDO_CONNECTION_KEY(src, dest) (((guint)(src) << 8) | (dest))
 
-	while(g_hash_table_iter_next(&iter, &pkey, &pvalue))
-	{
-		key = (duplication_key *)pkey;
+/* get the duplication state of a connection, allocated on first use */
+static struct sdo_seq_frames *
+epl_duplication_get_connection(struct epl_capture *capture, guint8 src, guint8 dest)
+{
+	struct sdo_seq_frames *dup;
+	gpointer key = GUINT_TO_POINTER(SDO_CONNECTION_KEY(src, dest));
 
-		if((src == key->src) && (dest == key->dest))
-		{
-			/* remove the key + value from the hash table */
-			g_hash_table_iter_remove(&iter);
-		}
+	dup = (struct sdo_seq_frames*)wmem_map_lookup(capture->duplication, key);
+	if (!dup)
+	{
+		dup = wmem_new0(wmem_file_scope(), struct sdo_seq_frames);
+		sdo_seq_frames_init(dup);
+		wmem_map_insert(capture->duplication, key, dup);
 	}
+	return dup;
 }
 
-/* insert function */
-static void
-epl_duplication_insert(GHashTable* table, gpointer ptr, guint32 frame)
+/* get the segmented download (write) or upload (read) of a connection */
+static struct sdo_transfer *
+epl_sdo_transfer_get(struct epl_capture *capture, guint8 src, guint8 dest, gboolean read)
 {
-	duplication_data *data = NULL;
-	duplication_key *key = NULL;
-	gpointer pkey = NULL;
-	gpointer pdata;
+	struct sdo_transfer *transfer;
+	gpointer key = GUINT_TO_POINTER(SDO_CONNECTION_KEY(src, dest) << 1 | (read ? 1 : 0));
 
-	/* check if the values are stored */
-	if(g_hash_table_lookup_extended(table,ptr,&pkey,&pdata))
+	transfer = (struct sdo_transfer*)wmem_map_lookup(capture->sdo_transfers, key);
+	if (!transfer)
 	{
-		data = (duplication_data *)pdata;
-		data->frame = frame;
-		g_hash_table_insert(table, pkey, data);
-	}
-	/* insert the data struct into the table */
-	else
-	{
-		key = (duplication_key *)wmem_memdup(wmem_file_scope(), ptr,sizeof(duplication_key));
-		/* create memory */
-		data = (duplication_data *)wmem_alloc0(wmem_file_scope(), sizeof(duplication_data));
-		data->frame = frame;
-		g_hash_table_insert(table,(gpointer)key, data);
+		transfer = wmem_new0(wmem_file_scope(), struct sdo_transfer);
+		transfer->first = TRUE;
+		sdo_seq_frames_init(&transfer->frames);
+		wmem_map_insert(capture->sdo_transfers, key, transfer);
 	}
+	return transfer;
 }
 
-/* create a key*/
-static gpointer
-epl_duplication_key(guint8 src, guint8 dest, guint8 seq_recv, guint8 seq_send)
+static gboolean
+epl_capture_del_cb(wmem_allocator_t *pool _U_, wmem_cb_event_t event _U_, void *_capture)
 {
-	duplication_key *key = g_slice_new(duplication_key);
+	struct epl_capture *capture = (struct epl_capture*)_capture;
 
-	key->src = src;
-	key->dest = dest;
-	key->seq_recv = seq_recv;
-	key->seq_send = seq_send;
+	G_LOCK(epl_captures);
+	g_hash_table_remove(epl_captures, capture->epan);
+	G_UNLOCK(epl_captures);
 
-	return (gpointer)key;
+	wmem_destroy_allocator(capture->pdo_mapping_scope);
+	reassembly_table_destroy(&capture->reassembly);
+	g_free(capture);
+
+	return FALSE;
 }
 
-/* get the saved data */
-static guint32
-epl_duplication_get(GHashTable* table, gpointer ptr)
+/* Per capture state of the session dissecting pinfo, created on first use.
+ * Sessions dissecting in parallel each get their own
+ */
+static struct epl_capture *
+epl_capture_get(packet_info *pinfo)
 {
-	duplication_data *data = NULL;
-	gpointer *pkey = NULL;
-	gpointer pdata;
+	struct epl_capture *capture;
 
-	if(g_hash_table_lookup_extended(table,ptr,pkey,&pdata))
+	G_LOCK(epl_captures);
+	capture = (struct epl_capture*)g_hash_table_lookup(epl_captures, pinfo->epan);
+	if (!capture)
 	{
-		data = (duplication_data *)pdata;
-		if(data->frame == 0x00)
-			return 0x00;
+		capture = g_new0(struct epl_capture, 1);
+		capture->epan = pinfo->epan;
+
+		/* per connection duplication and upload/download state,
+		 * allocated on demand and freed with the file scope */
+		capture->duplication = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+		capture->sdo_transfers = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+		/* create reassembly table */
+		reassembly_table_init(&capture->reassembly, &addresses_reassembly_table_functions);
+		/* free object mappings in one swoop */
+		capture->pdo_mapping_scope = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+		/* node states live in the file scope, the table is zeroed by g_new0 */
+
+		g_hash_table_insert(epl_captures, (gpointer)pinfo->epan, capture);
+		wmem_register_callback(wmem_file_scope(), epl_capture_del_cb, capture);
 	}
-	if(data != NULL)
-		return data->frame;
-	else
-		return 0x00;
+	G_UNLOCK(epl_captures);
+
+	return capture;
 }
 
 static void
-setup_dissector(void)
+epl_capture_free_mappings(gpointer key _U_, gpointer value, gpointer user_data _U_)
 {
-	/* init duplication hash table */
-	epl_duplication_table = g_hash_table_new(epl_duplication_hash, epl_duplication_equal);
-
-	/* create memory block for upload/download */
-	memset(&epl_asnd_sdo_reassembly_write, 0, sizeof(epl_sdo_reassembly));
-	memset(&epl_asnd_sdo_reassembly_read, 0, sizeof(epl_sdo_reassembly));
-	/* create reassembly table */
-	reassembly_table_init(&epl_reassembly_table, &addresses_reassembly_table_functions);
-	/* free object mappings in one swoop */
-	pdo_mapping_scope = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+	wmem_free_all(((struct epl_capture*)value)->pdo_mapping_scope);
 }
 
 static void
-cleanup_dissector(void)
+epl_captures_free_mappings(void)
 {
-	wmem_destroy_allocator(pdo_mapping_scope);
-	pdo_mapping_scope = NULL;
-	reassembly_table_destroy(&epl_reassembly_table);
-	/*g_hash_free(epl_duplication_table);*/
-	count = 0;
-	ct = 0;
-	first_read = TRUE;
-	first_write = TRUE;
+	G_LOCK(epl_captures);
+	g_hash_table_foreach(epl_captures, epl_capture_free_mappings, NULL);
+	G_UNLOCK(epl_captures);
 }
 
 /* preference whether or not display the SoC flags in info column */
 gboolean show_soc_flags = FALSE;
 
 /* Define the tap for epl */
-/*static gint epl_tap = -1;*/
+static gint epl_tap = -1;
+static gint epl_sdo_tap = -1;
 
 static guint16
 epl_get_sequence_nr(packet_info *pinfo)
@@ -2342,6 +3240,108 @@ epl_set_sequence_nr(packet_info *pinfo, guint16 seqnum)
 	p_add_proto_data ( wmem_file_scope(), pinfo, proto_epl, ETHERTYPE_EPL_V2, GUINT_TO_POINTER((guint)seqnum) );
 }
 
+#define EPL_SDO_STREAM_KEY 3
+#define EPL_SDO_CYCLE_KEY 4
+
+/* SoCs seen before an SDO frame, kept for revisits */
+static guint32
+epl_sdo_get_cycle(packet_info *pinfo)
+{
+	gpointer data;
+
+	if (!PINFO_FD_VISITED(pinfo))
+	{
+		guint32 cycles = epl_capture_get(pinfo)->cycles;
+
+		p_add_proto_data(wmem_file_scope(), pinfo, proto_epl, EPL_SDO_CYCLE_KEY, GUINT_TO_POINTER(cycles + 1));
+		return cycles;
+	}
+
+	data = p_get_proto_data(wmem_file_scope(), pinfo, proto_epl, EPL_SDO_CYCLE_KEY);
+	return data ? GPOINTER_TO_UINT(data) - 1 : 0;
+}
+
+/* Accounts a segment of a transfer instead of reassembling it, so memory
+ * stays the same no matter how big the transfer is. header_len is the size
+ * of an initiate segment's header in front of the data and 0 for the other
+ * segments. The totals are only kept, and returned, for the end segment.
+ */
+static const struct sdo_stream *
+sdo_stream_add(struct sdo_transfer *transfer, tvbuff_t *tvb, packet_info *pinfo, gint offset, gint length, gint header_len, gboolean end_segment)
+{
+	struct sdo_stream *stream = &transfer->stream;
+	struct sdo_stream *state = (struct sdo_stream*)p_get_proto_data(wmem_file_scope(), pinfo, proto_epl, EPL_SDO_STREAM_KEY);
+	guint32 cycles;
+
+	if (state || PINFO_FD_VISITED(pinfo))
+		return state;
+
+	cycles = epl_capture_get(pinfo)->cycles;
+
+	if (header_len)
+	{
+		memset(stream, 0, sizeof *stream);
+		stream->first_cycle = cycles;
+		/* the header starts with the data size and isn't part of the data */
+		if (length >= 4)
+			stream->size = tvb_get_letohl(tvb, offset);
+		header_len = MIN(header_len, length);
+		offset += header_len;
+		length -= header_len;
+	}
+
+	/* duplicated segments were accounted the first time around */
+	if (epl_get_sequence_nr(pinfo) != 0x01 && length > 0)
+	{
+		stream->crc = crc32_ccitt_tvb_offset_seed(tvb, offset, length, ~stream->crc);
+		stream->length += length;
+		stream->segments++;
+	}
+	stream->cycles = cycles - stream->first_cycle + 1;
+
+	if (!end_segment)
+		return NULL;
+
+	state = (struct sdo_stream*)wmem_memdup(wmem_file_scope(), stream, sizeof *stream);
+	p_add_proto_data(wmem_file_scope(), pinfo, proto_epl, EPL_SDO_STREAM_KEY, state);
+
+	return state;
+}
+
+static void
+dissect_epl_sdo_stream(proto_tree *tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, gint length, const struct sdo_stream *stream, gboolean end_segment)
+{
+	proto_item *ti;
+	proto_tree *stream_tree;
+
+	if (!stream)
+		return;
+
+	if (end_segment)
+		col_append_fstr(pinfo->cinfo, COL_INFO, " (Streamed %u bytes)", stream->length);
+
+	if (!tree)
+		return;
+
+	ti = proto_tree_add_item(tree, hf_epl_asnd_sdo_cmd_stream, tvb, offset, length, ENC_NA);
+	PROTO_ITEM_SET_GENERATED(ti);
+	stream_tree = proto_item_add_subtree(ti, ett_epl_asnd_sdo_stream);
+
+	ti = proto_tree_add_uint(stream_tree, hf_epl_asnd_sdo_cmd_stream_size, tvb, offset, length, stream->size);
+	PROTO_ITEM_SET_GENERATED(ti);
+	ti = proto_tree_add_uint(stream_tree, hf_epl_asnd_sdo_cmd_stream_length, tvb, offset, length, stream->length);
+	PROTO_ITEM_SET_GENERATED(ti);
+	ti = proto_tree_add_uint(stream_tree, hf_epl_asnd_sdo_cmd_stream_segments, tvb, offset, length, stream->segments);
+	PROTO_ITEM_SET_GENERATED(ti);
+	ti = proto_tree_add_uint(stream_tree, hf_epl_asnd_sdo_cmd_stream_crc, tvb, offset, length, stream->crc);
+	PROTO_ITEM_SET_GENERATED(ti);
+	ti = proto_tree_add_uint(stream_tree, hf_epl_asnd_sdo_cmd_stream_cycles, tvb, offset, length, stream->cycles);
+	PROTO_ITEM_SET_GENERATED(ti);
+	ti = proto_tree_add_uint(stream_tree, hf_epl_asnd_sdo_cmd_stream_bytes_per_cycle, tvb, offset, length,
+			stream->length / stream->cycles);
+	PROTO_ITEM_SET_GENERATED(ti);
+}
+
 static void
 elp_version( gchar *result, guint32 version )
 {
@@ -2353,7 +3353,7 @@ dissect_eplpdu(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboolean udp
 {
 	guint8 epl_mtyp;
 	const  gchar *src_str, *dest_str;
-	/* static epl_info_t mi; */
+	struct epl_info *info;
 	/* Set up structures needed to add the protocol subtree and manage it */
 	proto_item *ti;
 	proto_tree *epl_tree = NULL, *epl_src_item, *epl_dest_item;
@@ -2388,11 +3388,6 @@ dissect_eplpdu(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboolean udp
 	if (dissector_try_heuristic(heur_epl_subdissector_list, tvb, pinfo, tree, &hdtbl_entry, &epl_mtyp))
 		return TRUE;
 
-	/* tap */
-	/*  mi.epl_mtyp = epl_mtyp;
-	tap_queue_packet(epl_tap, pinfo, &mi);
-	*/
-
 	/* IP addresses are always in 192.168.100.0/24
 	 * with last octet being the node id
 	 * The original src/dest node ids are reserved
@@ -2403,14 +3398,17 @@ dissect_eplpdu(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboolean udp
 	/* Get Destination */
 	pinfo->destport = !udpencap ? tvb_get_guint8(tvb, EPL_DEST_OFFSET)
 	                            : ((guint8*)pinfo->net_dst.data)[3];
-	epl_segmentation.dest = pinfo->destport;
-	dest_str = decode_epl_address(pinfo->destport);
 
 	/* Get Source */
 	pinfo->srcport = !udpencap ? tvb_get_guint8(tvb, EPL_SRC_OFFSET)
 	                           : ((guint8*)pinfo->net_src.data)[3];
-	epl_segmentation.src = pinfo->srcport;
-	src_str = decode_epl_address(pinfo->srcport);
+
+	/* tap, the message dissectors fill in the rest */
+	info = wmem_new0(pinfo->pool, struct epl_info);
+	info->mtyp = epl_mtyp;
+	info->src = pinfo->srcport;
+	info->dest = pinfo->destport;
+	tap_queue_packet(epl_tap, pinfo, info);
 
 	col_clear(pinfo->cinfo, COL_INFO);
 
@@ -2462,6 +3460,9 @@ dissect_eplpdu(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboolean udp
 
 	if (tree && !udpencap)
 	{
+		dest_str = decode_epl_address(pinfo->destport);
+		src_str = decode_epl_address(pinfo->srcport);
+
 		epl_dest_item = proto_tree_add_item(epl_tree, hf_epl_node, tvb, offset, 1, ENC_LITTLE_ENDIAN);
 		PROTO_ITEM_SET_HIDDEN(epl_dest_item);
 		epl_dest_item = proto_tree_add_item(epl_tree, hf_epl_dest, tvb, offset, 1, ENC_LITTLE_ENDIAN);
@@ -2484,29 +3485,29 @@ dissect_eplpdu(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboolean udp
 	{
 		struct epl_convo *convo;
 		case EPL_SOC:
-			offset = dissect_epl_soc(epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_soc(info, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_PREQ:
 			convo = epl_get_convo(pinfo, CONVO_FOR_REQUEST);
-			offset = dissect_epl_preq(convo, epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_preq(info, convo, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_PRES:
 			convo = epl_get_convo(pinfo, CONVO_FOR_RESPONSE);
-			offset = dissect_epl_pres(convo, epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_pres(info, convo, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_SOA:
-			offset = dissect_epl_soa(epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_soa(info, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_ASND:
-			offset = dissect_epl_asnd(epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd(info, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_AINV:
-			offset = dissect_epl_ainv(epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_ainv(info, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_AMNI:
@@ -2615,7 +3616,7 @@ dissect_epl_payload(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gin
 }
 
 gint
-dissect_epl_soc(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_soc(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	nstime_t nettime;
 	guint8  flags;
@@ -2625,6 +3626,10 @@ dissect_epl_soc(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint of
 		NULL
 	};
 
+	/* cycles are the time base of streamed SDO transfers */
+	if (!PINFO_FD_VISITED(pinfo))
+		epl_capture_get(pinfo)->cycles++;
+
 	offset += 1;
 
 	flags = tvb_get_guint8(tvb, offset);
@@ -2642,6 +3647,9 @@ dissect_epl_soc(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint of
 	nettime.nsecs = tvb_get_letohl(tvb, offset+4);
 	proto_tree_add_time(epl_tree, hf_epl_soc_nettime, tvb, offset, 8, &nettime);
 
+	info->nettime = nettime;
+	info->relativetime = tvb_get_letoh64(tvb, offset+8);
+
 	proto_tree_add_item(epl_tree, hf_epl_soc_relativetime, tvb, offset+8, 8, ENC_LITTLE_ENDIAN);
 	offset += 16;
 
@@ -2651,7 +3659,7 @@ dissect_epl_soc(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint of
 
 
 gint
-dissect_epl_preq(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_preq(struct epl_info *info, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint16 len;
 	guint8  pdoversion;
@@ -2680,8 +3688,12 @@ dissect_epl_preq(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, p
 	col_append_fstr(pinfo->cinfo, COL_INFO, "[%4d]  F:RD=%d  V:%d.%d", len,
 			(EPL_PDO_RD_MASK & flags), hi_nibble(pdoversion), lo_nibble(pdoversion));
 
+	info->pdo_version = pdoversion;
+	info->payload_size = len;
+
 	offset += 2;
 	offset = dissect_epl_pdo(convo, epl_tree, tvb, pinfo, offset, len, EPL_PREQ );
+	info->pdo = epl_get_pdo_values(pinfo);
 
 	return offset;
 }
@@ -2689,7 +3701,7 @@ dissect_epl_preq(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, p
 
 
 gint
-dissect_epl_pres(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_pres(struct epl_info *info, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint16  len;
 	guint8  pdoversion;
@@ -2747,15 +3759,21 @@ dissect_epl_pres(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, p
 	}
 
 
+	info->has_nmt_state = TRUE;
+	info->nmt_state = state;
+	info->pdo_version = pdoversion;
+	info->payload_size = len;
+
 	offset += 2;
 	offset = dissect_epl_pdo(convo, epl_tree, tvb, pinfo, offset, len, EPL_PRES );
+	info->pdo = epl_get_pdo_values(pinfo);
 
 	return offset;
 }
 
 
 gint
-dissect_epl_soa(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_soa(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint8 svid, target;
 	guint8 state;
@@ -2763,6 +3781,8 @@ dissect_epl_soa(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint of
 	proto_tree *psf_tree  = NULL;
 
 	state = tvb_get_guint8(tvb, offset);
+	info->has_nmt_state = TRUE;
+	info->nmt_state = state;
 	if (pinfo->srcport != EPL_MN_NODEID)   /* check if CN or MN */
 	{
 		proto_tree_add_item(epl_tree, hf_epl_soa_stat_cs, tvb, offset, 1, ENC_LITTLE_ENDIAN);
@@ -2870,7 +3890,7 @@ dissect_epl_soa(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint of
 
 
 gint
-dissect_epl_asnd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_asnd(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint8  svid;
 	gint size, reported_len;
@@ -2892,11 +3912,11 @@ dissect_epl_asnd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint o
 		struct epl_convo *convo;
 		case EPL_ASND_IDENTRESPONSE:
 			convo = epl_get_convo(pinfo, CONVO_FOR_REQUEST | CONVO_ALWAYS_CREATE);
-			offset = dissect_epl_asnd_ires(convo, epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd_ires(info, convo, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_ASND_STATUSRESPONSE:
-			offset = dissect_epl_asnd_sres(epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd_sres(info, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_ASND_NMTREQUEST:
@@ -2909,7 +3929,7 @@ dissect_epl_asnd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint o
 
 		case EPL_ASND_SDO:
 			subtree = proto_item_add_subtree ( item, ett_epl_sdo );
-			offset = dissect_epl_asnd_sdo(subtree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd_sdo(info, subtree, tvb, pinfo, offset);
 			break;
 		case EPL_ASND_SYNCRESPONSE:
 			offset = dissect_epl_asnd_resp(epl_tree, tvb, pinfo, offset);
@@ -2932,12 +3952,15 @@ dissect_epl_asnd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint o
 }
 
 gint
-dissect_epl_ainv(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_ainv(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint8 svid;
 	proto_item *item;
 	proto_tree *subtree;
 
+	info->has_nmt_state = TRUE;
+	info->nmt_state = tvb_get_guint8(tvb, offset);
+
 	if (pinfo->srcport != EPL_MN_NODEID)   /* check if CN or MN */
 	{
 		proto_tree_add_item(epl_tree, hf_epl_soa_stat_cs, tvb, offset, 1, ENC_LITTLE_ENDIAN);
@@ -2965,11 +3988,11 @@ dissect_epl_ainv(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint o
 		struct epl_convo *convo;
 		case EPL_ASND_IDENTRESPONSE:
 			convo = epl_get_convo(pinfo, CONVO_FOR_RESPONSE | CONVO_ALWAYS_CREATE);
-			offset = dissect_epl_asnd_ires(convo, epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd_ires(info, convo, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_ASND_STATUSRESPONSE:
-			offset = dissect_epl_asnd_sres(epl_tree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd_sres(info, epl_tree, tvb, pinfo, offset);
 			break;
 
 		case EPL_ASND_NMTREQUEST:
@@ -2988,7 +4011,7 @@ dissect_epl_ainv(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint o
 
 		case EPL_ASND_SDO:
 			subtree = proto_item_add_subtree ( item, ett_epl_sdo );
-			offset = dissect_epl_asnd_sdo(subtree, tvb, pinfo, offset);
+			offset = dissect_epl_asnd_sdo(info, subtree, tvb, pinfo, offset);
 			break;
 	}
 
@@ -3122,13 +4145,36 @@ dissect_epl_asnd_nmtcmd(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo,
 
 
 gint
-dissect_epl_asnd_ires(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_asnd_ires(struct epl_info *info, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint16 additional;
 	guint32 epl_asnd_identresponse_ipa, epl_asnd_identresponse_snm, epl_asnd_identresponse_gtw;
 	proto_item  *ti_feat, *ti;
 	proto_tree  *epl_feat_tree;
 
+	info->has_nmt_state = TRUE;
+	info->nmt_state = tvb_get_guint8(tvb, offset + EPL_ASND_IRES_NMT_OFFSET);
+
+	if (!epl_tree)
+	{
+		/* Nothing to display, only pick up the node's identity,
+		 * in the same order as below, so a truncated frame stops at
+		 * the same field
+		 */
+		convo->ResponseTime = tvb_get_letohl(tvb, offset + EPL_ASND_IRES_RST_OFFSET);
+		convo->DeviceType = tvb_get_letohs(tvb, offset + EPL_ASND_IRES_DT_OFFSET);
+		tvb_ensure_bytes_exist(tvb, offset + EPL_ASND_IRES_DT_OFFSET + 2, 2); /* additional information */
+		if (!convo->profile || !convo->profile->nodeid)
+			epl_update_convo_cn_profile(convo);
+		convo->VendorId = tvb_get_letohl(tvb, offset + EPL_ASND_IRES_VID_OFFSET);
+		convo->ProductCode = tvb_get_letohl(tvb, offset + EPL_ASND_IRES_PC_OFFSET);
+		tvb_ensure_bytes_exist(tvb, offset, EPL_ASND_IRES_SIZE);
+
+		col_append_str(pinfo->cinfo, COL_INFO, val_to_str(convo->DeviceType, epl_device_profiles, "Device Profile %d"));
+
+		return offset + EPL_ASND_IRES_SIZE;
+	}
+
 	proto_tree_add_item(epl_tree, hf_epl_asnd_identresponse_en, tvb, offset, 1, ENC_LITTLE_ENDIAN);
 	proto_tree_add_item(epl_tree, hf_epl_asnd_identresponse_ec, tvb, offset, 1, ENC_LITTLE_ENDIAN);
 	offset += 1;
@@ -3317,7 +4363,7 @@ dissect_epl_asnd_resp(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo _U
 }
 
 gint
-dissect_epl_asnd_sres(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_asnd_sres(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	proto_item  *ti_el_entry, *ti_el_entry_type;
 	proto_tree  *epl_seb_tree, *epl_el_tree, *epl_el_entry_tree, *epl_el_entry_type_tree;
@@ -3335,6 +4381,9 @@ dissect_epl_asnd_sres(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, g
 	nmt_state = tvb_get_guint8(tvb, offset);
 	col_append_fstr(pinfo->cinfo, COL_INFO, "%s   ", val_to_str(nmt_state, epl_nmt_cs_vals, "Unknown (%d)"));
 
+	info->has_nmt_state = TRUE;
+	info->nmt_state = nmt_state;
+
 	if (pinfo->srcport != EPL_MN_NODEID)   /* check if CN or MN */
 	{
 		proto_tree_add_uint(epl_tree, hf_epl_asnd_statusresponse_stat_cs, tvb, offset, 1, nmt_state);
@@ -3364,6 +4413,10 @@ dissect_epl_asnd_sres(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, g
 	/* get the number of entries in the error code list*/
 	number_of_entries = (tvb_reported_length(tvb)-offset)/20;
 
+	/* the entries are only displayed */
+	if (!epl_tree)
+		return offset + number_of_entries * 20;
+
 	epl_el_tree = proto_tree_add_subtree_format(epl_tree, tvb, offset, -1, ett_epl_el, NULL, "ErrorCodeList: %d entries", number_of_entries);
 
 	/*Dissect the whole Error List (display each entry)*/
@@ -3405,35 +4458,58 @@ dissect_epl_asnd_sres(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, g
 }
 
 gint
-dissect_epl_asnd_sdo(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
+dissect_epl_asnd_sdo(struct epl_info *info, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset)
 {
 	guint16 seqnum = 0x00;
 	guint8 seq_read;
-	offset = dissect_epl_sdo_sequence(epl_tree, tvb, pinfo, offset, &seq_read);
+	guint32 cycle;
+	struct epl_segmentation segmentation = {0};
+
+	segmentation.src = pinfo->srcport;
+	segmentation.dest = pinfo->destport;
+
+	cycle = epl_sdo_get_cycle(pinfo);
+	if (have_tap_listener(epl_sdo_tap) || have_tap_listener(epl_tap))
+	{
+		info->has_sdo = TRUE;
+		segmentation.info = &info->sdo;
+		segmentation.info->src = segmentation.src;
+		segmentation.info->dest = segmentation.dest;
+		segmentation.info->node = segmentation.src == EPL_MN_NODEID ? segmentation.dest : segmentation.src;
+		segmentation.info->cycle = cycle;
+	}
+
+	offset = dissect_epl_sdo_sequence(&segmentation, epl_tree, tvb, pinfo, offset, &seq_read);
 
 	seqnum = epl_get_sequence_nr(pinfo);
+	if (segmentation.info)
+		segmentation.info->duplicate = seqnum == 0x01;
 
 	/* if a frame is duplicated don't show the command layer */
 	if(seqnum == 0x00 || show_cmd_layer_for_duplicated == TRUE )
 	{
 		if (tvb_reported_length_remaining(tvb, offset) > 0)
 		{
-			offset = dissect_epl_sdo_command(epl_tree, tvb, pinfo, offset, seq_read);
+			offset = dissect_epl_sdo_command(&segmentation, epl_tree, tvb, pinfo, offset, seq_read);
 		}
 		else col_append_str(pinfo->cinfo, COL_INFO, "Empty CommandLayer");
 	}
+
+	if (segmentation.info)
+		tap_queue_packet(epl_sdo_tap, pinfo, segmentation.info);
+
 	return offset;
 }
 
 gint
-dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8* seq)
+dissect_epl_sdo_sequence(struct epl_segmentation *segmentation, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8* seq)
 {
 	guint8 seq_recv = 0x00, seq_send = 0x00, rcon = 0x00, scon = 0x00;
 	guint32 frame = 0x00;
 	proto_tree *sod_seq_tree;
 	proto_item *item;
 	guint8 duplication = 0x00;
-	gpointer key;
+	struct sdo_seq_frames *dup;
 	guint32 saved_frame;
 	guint16 seqnum = 0;
 
@@ -3443,22 +4519,22 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 	rcon = seq_recv & EPL_ASND_SDO_SEQ_CON_MASK;
 	/* get seq_recv */
 	seq_recv = seq_recv >> EPL_ASND_SDO_SEQ_MASK;
-	epl_segmentation.recv = seq_recv;
+	segmentation->recv = seq_recv;
 	/* read buffer */
 	seq_send = tvb_get_guint8(tvb, offset+1);
 	/* get scon */
 	scon = seq_send & EPL_ASND_SDO_SEQ_CON_MASK;
 	/* get seq_send */
 	seq_send = seq_send >> EPL_ASND_SDO_SEQ_MASK;
-	epl_segmentation.send = seq_send;
+	segmentation->send = seq_send;
 	/* get the current frame-number */
 	frame = pinfo->num;
 
-	/* Create a key */
-	key = epl_duplication_key(epl_segmentation.src,epl_segmentation.dest,seq_recv,seq_send);
+	/* Get the state of this connection */
+	dup = epl_duplication_get_connection(epl_capture_get(pinfo), segmentation->src, segmentation->dest);
 
 	/* Get the saved data */
-	saved_frame = epl_duplication_get(epl_duplication_table, key);
+	saved_frame = sdo_seq_frames_get(dup, seq_recv, seq_send);
 
 	/* clear array at the start Sequence */
 	if((rcon < EPL_VALID && scon < EPL_VALID)
@@ -3466,7 +4542,7 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 		||(rcon < EPL_VALID && scon == EPL_VALID))
 	{
 		/* remove all the keys of the specified src and dest address*/
-		epl_duplication_remove(epl_duplication_table,epl_segmentation.src,epl_segmentation.dest);
+		sdo_seq_frames_reset(dup);
 		/* There is no cmd layer */
 		epl_set_sequence_nr(pinfo, 0x02);
 	}
@@ -3499,7 +4575,7 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 		if((rcon == EPL_VALID && scon == EPL_RETRANSMISSION) || (rcon == EPL_RETRANSMISSION && scon == EPL_VALID))
 		{
 			/* replace the saved frame with the new frame */
-			epl_duplication_insert(epl_duplication_table, key, frame);
+			sdo_seq_frames_set(dup, seq_recv, seq_send, frame);
 		}
 		/* if connection valid */
 		else
@@ -3508,7 +4584,7 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 			if(saved_frame == 0x00)
 			{
 				/* store the new frame in the hash table */
-				epl_duplication_insert(epl_duplication_table,key,frame);
+				sdo_seq_frames_set(dup, seq_recv, seq_send, frame);
 			}
 			/* if the frame is bigger than the stored frame + the max frame offset
 			   or the saved frame is bigger that the current frame then store the current
@@ -3517,7 +4593,7 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 				||(saved_frame > frame)))
 			{
 				/* store the new frame in the hash table */
-				epl_duplication_insert(epl_duplication_table,key,frame);
+				sdo_seq_frames_set(dup, seq_recv, seq_send, frame);
 			}
 			else if((frame < (saved_frame + EPL_MAX_FRAME_OFFSET))
 				&&(frame > saved_frame))
@@ -3536,13 +4612,18 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 			"Duplication of Frame: %d ReceiveSequenceNumber: %d and SendSequenceNumber: %d ",
 			saved_frame,seq_recv,seq_send );
 	}
+	if (segmentation->info)
+	{
+		segmentation->info->seq_recv = seq_recv;
+		segmentation->info->seq_send = seq_send;
+		segmentation->info->retransmission = rcon == EPL_RETRANSMISSION;
+	}
 	/* if the last frame in the ReceiveSequence is sent get new memory */
 	if(seq_recv == 0x3f && seq_send <= 0x3f)
 	{
 		/* reset all entries of the transfer */
-		epl_duplication_remove(epl_duplication_table,epl_segmentation.src,epl_segmentation.dest);
+		sdo_seq_frames_reset(dup);
 	}
-	free_key(key);
 	item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_seq, tvb,  offset, 5, ENC_NA);
 	sod_seq_tree = proto_item_add_subtree(item, ett_epl_sdo_sequence_layer);
 	/* Asynchronuous SDO Sequence Layer */
@@ -3571,7 +4652,7 @@ dissect_epl_sdo_sequence(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo
 }
 
 gint
-dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 seq)
+dissect_epl_sdo_command(struct epl_segmentation *segmentation, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 seq)
 {
 	gint    payload_length;
 	guint8  segmented, command_id, transaction_id;
@@ -3603,6 +4684,18 @@ dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo,
 
 		segment_size = tvb_get_letohs(tvb, offset + 3);
 
+		if (segmentation->info)
+		{
+			struct epl_sdo_info *info = segmentation->info;
+			info->has_command = TRUE;
+			info->response = response;
+			info->abort = abort_flag;
+			info->command_id = command_id;
+			info->transaction_id = transaction_id;
+			info->segmentation = segmented;
+			info->length = segment_size;
+		}
+
 		col_append_fstr(pinfo->cinfo, COL_INFO, "Cmd:%s,TID=%02d ",
 						val_to_str(segmented, epl_sdo_asnd_cmd_segmentation_abbr, " Inv(%d)"), transaction_id);
 
@@ -3630,33 +4723,35 @@ dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo,
 		{
 			if((command_id == EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX) || (command_id == EPL_ASND_SDO_COMMAND_READ_BY_INDEX))
 			{
+				struct epl_capture *capture = epl_capture_get(pinfo);
+				struct sdo_transfer *transfer = epl_sdo_transfer_get(capture, segmentation->src, segmentation->dest,
+						command_id == EPL_ASND_SDO_COMMAND_READ_BY_INDEX);
+
+				/* if download or upload => reset counter */
 				if (sendCon != EPL_ASND_SDO_SEQ_SEND_CON_ERROR_VALID_ACK_REQ)
-				{
-					/* if download => reset counter */
-					if(command_id == EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX)
-						ct = 0x00;
-					/* if upload => reset counter */
-					else if(command_id == EPL_ASND_SDO_COMMAND_READ_BY_INDEX)
-						count = 0x00;
-				}
+					transfer->seq = 0x00;
 				/* payload length */
 				payload_length = tvb_reported_length_remaining(tvb, offset);
 				/* create a key for reassembly => first 16 bit are src-address and
 				last 16 bit are the dest-address */
-				fragmentId = (guint32)((((guint32)epl_segmentation.src)<<16)+epl_segmentation.dest);
-				/* set fragmented flag */
-				pinfo->fragmented = TRUE;
-				fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
-												fragmentId, NULL, 0, payload_length, TRUE );
-				fragment_add_seq_offset ( &epl_reassembly_table, pinfo, fragmentId, NULL, 0 );
-				if (command_id == EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX)
+				fragmentId = (guint32)((((guint32)segmentation->src)<<16)+segmentation->dest);
+				if (stream_sdo_transfers)
 				{
-					first_write = FALSE;
+					/* a write's initiate segment also holds the index, subindex and a reserved byte */
+					gint header_len = command_id == EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX ? 8 : 4;
+
+					dissect_epl_sdo_stream(sdo_cmd_tree, tvb, pinfo, offset, payload_length,
+							sdo_stream_add(transfer, tvb, pinfo, offset, payload_length, header_len, FALSE), FALSE);
 				}
 				else
 				{
-					first_read = FALSE;
+					/* set fragmented flag */
+					pinfo->fragmented = TRUE;
+					fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
+							fragmentId, NULL, 0, payload_length, TRUE );
+					fragment_add_seq_offset ( &capture->reassembly, pinfo, fragmentId, NULL, 0 );
 				}
+				transfer->first = FALSE;
 				/* if Segmentation = Initiate then print DataSize */
 				proto_tree_add_item(sdo_cmd_tree, hf_epl_asnd_sdo_cmd_data_size, tvb, offset, 4, ENC_LITTLE_ENDIAN);
 				segmented = TRUE;
@@ -3710,11 +4805,12 @@ dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo,
 			enum convo_opts opts = is_response ? CONVO_FOR_RESPONSE : CONVO_FOR_REQUEST;
 			struct epl_convo *convo = epl_get_convo(pinfo, opts);
 			convo->seq_send = seq;
+			convo->transaction_id = transaction_id;
 
 			switch (command_id)
 			{
 			case EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX:
-				offset = dissect_epl_sdo_command_write_by_index(convo, sdo_cmd_tree, tvb, pinfo, offset, segmented, response, segment_size);
+				offset = dissect_epl_sdo_command_write_by_index(segmentation, convo, sdo_cmd_tree, tvb, pinfo, offset, segmented, response, segment_size);
 				break;
 
 			case EPL_ASND_SDO_COMMAND_WRITE_MULTIPLE_PARAMETER_BY_INDEX:
@@ -3722,7 +4818,7 @@ dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo,
 				break;
 
 			case EPL_ASND_SDO_COMMAND_READ_BY_INDEX:
-				offset = dissect_epl_sdo_command_read_by_index(convo, sdo_cmd_tree, tvb, pinfo, offset, segmented, response, segment_size);
+				offset = dissect_epl_sdo_command_read_by_index(segmentation, convo, sdo_cmd_tree, tvb, pinfo, offset, segmented, response, segment_size);
 				break;
 
 			default:
@@ -3734,7 +4830,7 @@ dissect_epl_sdo_command(proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo,
 }
 
 gint
-dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size)
+dissect_epl_sdo_command_write_by_index(struct epl_segmentation *segmentation, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size)
 {
 	gint size, payload_length = 0;
 	guint16 idx = 0x00, param_index = 0x00, sod_index = 0x00, error = 0xFF, sub_val = 0x00;
@@ -3770,17 +4866,17 @@ dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_
 				index_str = rval_to_str_const(idx, sod_cmd_str, "unknown");
 				/* get index string value */
 				sod_index = str_to_val(index_str, sod_cmd_str_val, error);
-
-				/* get subindex string */
-				sub_index_str = val_to_str_ext_const(idx, &sod_cmd_no_sub, "unknown");
-				/* get subindex string value */
-				nosub = str_to_val(sub_index_str, sod_cmd_str_no_sub, 0xFF) != 0xFF;
 			}
 			offset += 2;
 
 			/* get subindex offset */
 			param_subindex = subindex = tvb_get_guint8(tvb, offset);
-			subobj = subobject_lookup(obj, subindex);
+
+			if (segmentation->info)
+			{
+				segmentation->info->idx = param_index;
+				segmentation->info->subindex = param_subindex;
+			}
 
 
 			/* get subindex string */
@@ -3788,102 +4884,139 @@ dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_
 			/* get string value */
 			sub_val = str_to_val(sub_str, sod_cmd_sub_str_val, error);
 
-			col_append_fstr(pinfo->cinfo, COL_INFO, "%s[%d]: (0x%04X/%d)",
-							val_to_str_ext(EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX, &epl_sdo_asnd_commands_short_ext, "Command(%02X)"),
-							segment_size, idx, subindex);
-
-			if(obj)
-			{
-				const char *name = obj->info.name;
-				proto_item_append_text(psf_item, " (%s)", name);
-				col_append_fstr(pinfo->cinfo, COL_INFO, " (%s", name);
-				nosub = obj->info.type_class == OD_ENTRY_NO_SUBINDICES;
-			}
-			else if (sod_index == error)
+			/* Neither tree nor columns to fill, only resolve
+			 * the index for the object mapping check below
+			 */
+			if (!epl_tree && !pinfo->cinfo)
 			{
-				const char *name = val_to_str_ext_const(((guint32)(idx<<16)), &sod_index_names, "User Defined");
-				proto_item_append_text(psf_item, " (%s)", name);
-				col_append_fstr(pinfo->cinfo, COL_INFO, " (%s", name);
+				if (!obj && sod_index != error)
+					idx = sod_index;
+				if (sub_val != error)
+					idx = sub_val;
 			}
-			else /* string is in list */
+			else
 			{
-				/* add index string to index item */
-				proto_item_append_text(psf_item," (%s", val_to_str_ext_const(((guint32)(sod_index<<16)), &sod_index_names, "User Defined"));
-				proto_item_append_text(psf_item,"_%02Xh", (idx-sod_index));
-				if(sod_index == EPL_SOD_PDO_RX_MAPP || sod_index == EPL_SOD_PDO_TX_MAPP)
+				subobj = subobject_lookup(obj, subindex);
+				if (!obj)
 				{
-					proto_item_append_text(psf_item,"_AU64)");
+					/* get subindex string */
+					sub_index_str = val_to_str_ext_const(idx, &sod_cmd_no_sub, "unknown");
+					/* get subindex string value */
+					nosub = str_to_val(sub_index_str, sod_cmd_str_no_sub, 0xFF) != 0xFF;
 				}
-				else
+
+				col_append_fstr(pinfo->cinfo, COL_INFO, "%s[%d]: (0x%04X/%d)",
+								val_to_str_ext(EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX, &epl_sdo_asnd_commands_short_ext, "Command(%02X)"),
+								segment_size, idx, subindex);
+
+				if(obj)
 				{
-					proto_item_append_text(psf_item,"_REC)");
+					const char *name = obj->info.name;
+					proto_item_append_text(psf_item, " (%s)", name);
+					col_append_fstr(pinfo->cinfo, COL_INFO, " (%s", name);
+					nosub = obj->info.type_class == OD_ENTRY_NO_SUBINDICES;
 				}
-				/* info text */
-				col_append_fstr(pinfo->cinfo, COL_INFO, " (%s", val_to_str_ext_const(((guint32)(sod_index << 16)), &sod_index_names, "User Defined"));
-				col_append_fstr(pinfo->cinfo, COL_INFO, "_%02Xh", (idx-sod_index));
-				if(sod_index == EPL_SOD_PDO_RX_MAPP || sod_index == EPL_SOD_PDO_TX_MAPP)
+				else if (sod_index == error)
 				{
-					col_append_fstr(pinfo->cinfo, COL_INFO, "_AU64");
+					const char *name = val_to_str_ext_const(((guint32)(idx<<16)), &sod_index_names, "User Defined");
+					proto_item_append_text(psf_item, " (%s)", name);
+					col_append_fstr(pinfo->cinfo, COL_INFO, " (%s", name);
 				}
-				else
+				else /* string is in list */
 				{
-					col_append_fstr(pinfo->cinfo, COL_INFO, "_REC");
+					/* add index string to index item */
+					proto_item_append_text(psf_item," (%s", val_to_str_ext_const(((guint32)(sod_index<<16)), &sod_index_names, "User Defined"));
+					proto_item_append_text(psf_item,"_%02Xh", (idx-sod_index));
+					if(sod_index == EPL_SOD_PDO_RX_MAPP || sod_index == EPL_SOD_PDO_TX_MAPP)
+					{
+						proto_item_append_text(psf_item,"_AU64)");
+					}
+					else
+					{
+						proto_item_append_text(psf_item,"_REC)");
+					}
+					/* info text */
+					col_append_fstr(pinfo->cinfo, COL_INFO, " (%s", val_to_str_ext_const(((guint32)(sod_index << 16)), &sod_index_names, "User Defined"));
+					col_append_fstr(pinfo->cinfo, COL_INFO, "_%02Xh", (idx-sod_index));
+					if(sod_index == EPL_SOD_PDO_RX_MAPP || sod_index == EPL_SOD_PDO_TX_MAPP)
+					{
+						col_append_fstr(pinfo->cinfo, COL_INFO, "_AU64");
+					}
+					else
+					{
+						col_append_fstr(pinfo->cinfo, COL_INFO, "_REC");
+					}
+					idx = sod_index;
 				}
-				idx = sod_index;
-			}
 
-			if(sub_val != error)
-				idx = sub_val;
+				if(sub_val != error)
+					idx = sub_val;
 
-			if (subobj)
-			{
-				psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
-				proto_item_append_text(psf_item, " (%s)", subobj->info.name);
-				col_append_fstr(pinfo->cinfo, COL_INFO, "/%s)", subobj->info.name);
-			}
-			/* if the subindex is a EPL_SOD_STORE_PARAM */
-			/* if the subindex is a EPL_SOD_RESTORE_PARAM */
-			else if((idx == EPL_SOD_STORE_PARAM && subindex <= 0x7F && subindex >= 0x04) ||
-					(idx == EPL_SOD_RESTORE_PARAM && subindex <= 0x7F && subindex >= 0x04))
-			{
-				psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
-				proto_item_append_text(psf_item, " (ManufacturerParam_%02Xh_U32)", subindex);
-				col_append_fstr(pinfo->cinfo, COL_INFO, "/ManufacturerParam_%02Xh_U32)", subindex);
-			}
-			/* if the subindex is a EPL_SOD_PDO_RX_MAPP */
-			/* if the subindex is a EPL_SOD_PDO_TX_MAPP */
-			else if((idx == EPL_SOD_PDO_RX_MAPP && subindex >= 0x01 && subindex <= 0xfe) ||
-					(idx == EPL_SOD_PDO_TX_MAPP && subindex >= 0x01 && subindex <= 0xfe))
-			{
-				psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
-				proto_item_append_text(psf_item, " (ObjectMapping)");
-				col_append_fstr(pinfo->cinfo, COL_INFO, "/ObjectMapping)");
-			}
-			/* no subindex */
-			else if(nosub)
-			{
-				col_append_fstr(pinfo->cinfo, COL_INFO, ")");
-			}
-			else if(subindex == 0x00)
-			{
-				psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
-				proto_item_append_text(psf_item, " (NumberOfEntries)");
-				col_append_fstr(pinfo->cinfo, COL_INFO, "/NumberOfEntries)");
-			}
-			else
-			{
-				psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
-				proto_item_append_text(psf_item, " (%s)", val_to_str_ext_const((subindex | (idx << 16)), &sod_index_names, "User Defined"));
-				col_append_fstr(pinfo->cinfo, COL_INFO, "/%s)",val_to_str_ext_const((subindex | (idx << 16)), &sod_index_names, "User Defined"));
+				if (subobj)
+				{
+					psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
+					proto_item_append_text(psf_item, " (%s)", subobj->info.name);
+					col_append_fstr(pinfo->cinfo, COL_INFO, "/%s)", subobj->info.name);
+				}
+				/* if the subindex is a EPL_SOD_STORE_PARAM */
+				/* if the subindex is a EPL_SOD_RESTORE_PARAM */
+				else if((idx == EPL_SOD_STORE_PARAM && subindex <= 0x7F && subindex >= 0x04) ||
+						(idx == EPL_SOD_RESTORE_PARAM && subindex <= 0x7F && subindex >= 0x04))
+				{
+					psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
+					proto_item_append_text(psf_item, " (ManufacturerParam_%02Xh_U32)", subindex);
+					col_append_fstr(pinfo->cinfo, COL_INFO, "/ManufacturerParam_%02Xh_U32)", subindex);
+				}
+				/* if the subindex is a EPL_SOD_PDO_RX_MAPP */
+				/* if the subindex is a EPL_SOD_PDO_TX_MAPP */
+				else if((idx == EPL_SOD_PDO_RX_MAPP && subindex >= 0x01 && subindex <= 0xfe) ||
+						(idx == EPL_SOD_PDO_TX_MAPP && subindex >= 0x01 && subindex <= 0xfe))
+				{
+					psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
+					proto_item_append_text(psf_item, " (ObjectMapping)");
+					col_append_fstr(pinfo->cinfo, COL_INFO, "/ObjectMapping)");
+				}
+				/* no subindex */
+				else if(nosub)
+				{
+					col_append_fstr(pinfo->cinfo, COL_INFO, ")");
+				}
+				else if(subindex == 0x00)
+				{
+					psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
+					proto_item_append_text(psf_item, " (NumberOfEntries)");
+					col_append_fstr(pinfo->cinfo, COL_INFO, "/NumberOfEntries)");
+				}
+				else
+				{
+					psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
+					proto_item_append_text(psf_item, " (%s)", val_to_str_ext_const((subindex | (idx << 16)), &sod_index_names, "User Defined"));
+					col_append_fstr(pinfo->cinfo, COL_INFO, "/%s)",val_to_str_ext_const((subindex | (idx << 16)), &sod_index_names, "User Defined"));
+				}
 			}
 			offset += 2;
 		}
+		/* Download, accounted only */
+		else if(stream_sdo_transfers && ((segmented == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE) ||
+			(segmented == EPL_ASND_SDO_CMD_SEGMENTATION_SEGMENT)))
+		{
+			struct sdo_transfer *transfer = epl_sdo_transfer_get(epl_capture_get(pinfo), segmentation->src, segmentation->dest, FALSE);
+
+			payload_length = tvb_reported_length_remaining(tvb, offset);
+			end_segment = segmented == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE;
+			dissect_epl_sdo_stream(epl_tree, tvb, pinfo, offset, payload_length,
+					sdo_stream_add(transfer, tvb, pinfo, offset, payload_length, 0, end_segment),
+					end_segment);
+		}
 		/* Download */
 		else if((segmented == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE) ||
 			(segmented == EPL_ASND_SDO_CMD_SEGMENTATION_SEGMENT))
 		{
+			struct epl_capture *capture = epl_capture_get(pinfo);
+			struct sdo_transfer *transfer = epl_sdo_transfer_get(capture, segmentation->src, segmentation->dest, FALSE);
+
 			/* get the fragmentId */
-			fragmentId = (guint32)((((guint32)epl_segmentation.src)<<16)+epl_segmentation.dest);
+			fragmentId = (guint32)((((guint32)segmentation->src)<<16)+segmentation->dest);
 			/* set the fragmented flag */
 			pinfo->fragmented = TRUE;
 
@@ -3894,72 +5027,78 @@ dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_
 				end_segment = TRUE;
 
 			/* if the send-sequence-number is at the end or the beginning of a sequence */
-			if(epl_segmentation.send == 0x3f || epl_segmentation.send <= 0x01 )
+			if(segmentation->send == 0x3f || segmentation->send <= 0x01 )
 			{
 				/* reset memory */
-				memset(&epl_asnd_sdo_reassembly_write,0,sizeof(epl_sdo_reassembly));
+				sdo_seq_frames_reset(&transfer->frames);
 				/* save the current frame and increase the counter */
-				epl_asnd_sdo_reassembly_write.frame[epl_segmentation.recv][epl_segmentation.send] = frame;
-				ct += 1;
+				sdo_seq_frames_set(&transfer->frames, segmentation->recv, segmentation->send, frame);
+				transfer->seq += 1;
 				/* add the frame to reassembly_table */
-				frag_msg = fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
-							  fragmentId, NULL, ct, payload_length, end_segment ? FALSE : TRUE );
+				frag_msg = fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
+							  fragmentId, NULL, transfer->seq, payload_length, end_segment ? FALSE : TRUE );
 			}
 			else
 			{
-				if(epl_asnd_sdo_reassembly_write.frame[epl_segmentation.recv][epl_segmentation.send] == 0x00)
+				if(sdo_seq_frames_get(&transfer->frames, segmentation->recv, segmentation->send) == 0x00)
 				{
 					/* save the current frame and increase counter */
-					epl_asnd_sdo_reassembly_write.frame[epl_segmentation.recv][epl_segmentation.send] = frame;
-					ct += 1;
+					sdo_seq_frames_set(&transfer->frames, segmentation->recv, segmentation->send, frame);
+					transfer->seq += 1;
 					/* add the frame to reassembly_table */
-					if (first_write)
+					if (transfer->first)
 					{
-						frag_msg = fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
+						frag_msg = fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
 							fragmentId, NULL, 0, payload_length, end_segment ? FALSE : TRUE );
-						fragment_add_seq_offset(&epl_reassembly_table, pinfo, fragmentId, NULL, ct);
+						fragment_add_seq_offset(&capture->reassembly, pinfo, fragmentId, NULL, transfer->seq);
 
-						first_write = FALSE;
+						transfer->first = FALSE;
 					}
 					else
 					{
-						frag_msg = fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
-							fragmentId, NULL, ct, payload_length, end_segment ? FALSE : TRUE );
+						frag_msg = fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
+							fragmentId, NULL, transfer->seq, payload_length, end_segment ? FALSE : TRUE );
 					}
 				}
 				else
 				{
-					frag_msg = fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
+					frag_msg = fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
 						fragmentId, NULL, 0, payload_length, end_segment ? FALSE : TRUE);
-					epl_asnd_sdo_reassembly_write.frame[epl_segmentation.recv][epl_segmentation.send] = frame;
+					sdo_seq_frames_set(&transfer->frames, segmentation->recv, segmentation->send, frame);
 				}
 			}
 
 			/* if the reassembly_table is not Null and the frame stored is the same as the current frame */
-			if(frag_msg != NULL && (epl_asnd_sdo_reassembly_write.frame[epl_segmentation.recv][epl_segmentation.send] == frame))
+			if(frag_msg != NULL && (sdo_seq_frames_get(&transfer->frames, segmentation->recv, segmentation->send) == frame))
 			{
-				/* if the frame is the last frame */
 				if(end_segment)
-				{
-					cmd_payload = proto_tree_add_uint_format(epl_tree, hf_epl_asnd_sdo_cmd_reassembled, tvb, offset, payload_length,0,
-															"Reassembled: %d bytes total (%d bytes in this frame)",frag_msg->len,payload_length);
-					payload_tree = proto_item_add_subtree(cmd_payload, ett_epl_asnd_sdo_data_reassembled);
-					/* add the reassembley fields */
-					process_reassembled_data(tvb, 0, pinfo, "Reassembled Message", frag_msg, &epl_frag_items, NULL, payload_tree );
-					proto_tree_add_uint_format_value(payload_tree, hf_epl_asnd_sdo_cmd_reassembled, tvb, 0, 0,
-									payload_length, "%d bytes (over all fragments)", frag_msg->len);
 					col_append_str(pinfo->cinfo, COL_INFO, " (Message Reassembled)" );
-				}
-				else
+
+				/* the reassembled message is only displayed, skip it without a tree */
+				if(epl_tree)
 				{
-					cmd_payload = proto_tree_add_uint_format(epl_tree, hf_epl_asnd_sdo_cmd_reassembled, tvb, offset, payload_length,0,
-														"Reassembled: %d bytes total (%d bytes in this frame)",frag_msg->len,payload_length);
-					payload_tree = proto_item_add_subtree(cmd_payload, ett_epl_asnd_sdo_data_reassembled);
-					/* add reassemble field => Reassembled in: */
-					process_reassembled_data(tvb, 0, pinfo, "Reassembled Message", frag_msg, &epl_frag_items, NULL, payload_tree );
+					/* if the frame is the last frame */
+					if(end_segment)
+					{
+						cmd_payload = proto_tree_add_uint_format(epl_tree, hf_epl_asnd_sdo_cmd_reassembled, tvb, offset, payload_length,0,
+																"Reassembled: %d bytes total (%d bytes in this frame)",frag_msg->len,payload_length);
+						payload_tree = proto_item_add_subtree(cmd_payload, ett_epl_asnd_sdo_data_reassembled);
+						/* add the reassembley fields */
+						process_reassembled_data(tvb, 0, pinfo, "Reassembled Message", frag_msg, &epl_frag_items, NULL, payload_tree );
+						proto_tree_add_uint_format_value(payload_tree, hf_epl_asnd_sdo_cmd_reassembled, tvb, 0, 0,
+										payload_length, "%d bytes (over all fragments)", frag_msg->len);
+					}
+					else
+					{
+						cmd_payload = proto_tree_add_uint_format(epl_tree, hf_epl_asnd_sdo_cmd_reassembled, tvb, offset, payload_length,0,
+															"Reassembled: %d bytes total (%d bytes in this frame)",frag_msg->len,payload_length);
+						payload_tree = proto_item_add_subtree(cmd_payload, ett_epl_asnd_sdo_data_reassembled);
+						/* add reassemble field => Reassembled in: */
+						process_reassembled_data(tvb, 0, pinfo, "Reassembled Message", frag_msg, &epl_frag_items, NULL, payload_tree );
+					}
 				}
-				first_write = TRUE;
-				ct = 0;
+				transfer->first = TRUE;
+				transfer->seq = 0;
 			}
 		}
 		size = tvb_reported_length_remaining(tvb, offset);
@@ -3968,7 +5107,7 @@ dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_
 		/* if the frame is a PDO Mapping and the subindex is bigger than 0x00 */
 		if((idx == EPL_SOD_PDO_TX_MAPP && subindex > 0x00) || (idx == EPL_SOD_PDO_RX_MAPP && subindex > 0x00))
 		{
-			wmem_array_t *mappings = idx == EPL_SOD_PDO_TX_MAPP ? convo->TPDO : convo->RPDO;
+			struct object_mappings *mappings = idx == EPL_SOD_PDO_TX_MAPP ? convo->TPDO : convo->RPDO;
 			offset = dissect_object_mapping(convo->profile, mappings, epl_tree, tvb, pinfo->num, offset, idx, subindex);
 		}
 		else
@@ -3985,16 +5124,60 @@ dissect_epl_sdo_command_write_by_index(struct epl_convo *convo, proto_tree *epl_
 	return offset;
 }
 
+/* Subtrees of mapped objects, one per (index, subindex).
+ * etts can't be unregistered, so mappings share them instead of
+ * registering a new one each time an object is (re)mapped.
+ * The same goes for the titles: default mappings of a profile outlive
+ * the capture, so they are interned here instead of in pdo_mapping_scope
+ */
+struct pdo_subtree {
+	gint ett;
+	char title[sizeof "PDO - FFFF:FF"];
+	char nosub_title[sizeof "PDO - FFFF"];
+};
+
+static wmem_map_t *epl_pdo_subtrees;
+G_LOCK_DEFINE_STATIC(epl_pdo_subtrees);
+
+static const struct pdo_subtree *
+pdo_subtree_lookup_or_add(guint16 idx, guint8 subindex)
+{
+	guint32 key = ((guint32)idx << 8) | subindex;
+	struct pdo_subtree *subtree;
+
+	/* sessions share the interned subtrees */
+	G_LOCK(epl_pdo_subtrees);
+	subtree = (struct pdo_subtree*)wmem_map_lookup(epl_pdo_subtrees, GUINT_TO_POINTER(key));
+	if (!subtree)
+	{
+		gint *ett;
+
+		subtree = wmem_new(wmem_epan_scope(), struct pdo_subtree);
+		subtree->ett = -1;
+		ett = &subtree->ett;
+		proto_register_subtree_array(&ett, 1);
+
+		/* TODO One could think of a better string here? */
+		g_snprintf(subtree->title, sizeof subtree->title, "PDO - %04X:%02X", idx, subindex);
+		g_snprintf(subtree->nosub_title, sizeof subtree->nosub_title, "PDO - %04X", idx);
+
+		wmem_map_insert(epl_pdo_subtrees, GUINT_TO_POINTER(key), subtree);
+	}
+	G_UNLOCK(epl_pdo_subtrees);
+
+	return subtree;
+}
+
 /** epl_tree may be null here, when this function is called from the profile parser */
 static gint
-dissect_object_mapping(struct profile *profile, wmem_array_t *mappings, proto_tree *epl_tree, tvbuff_t *tvb, guint32 framenum, gint offset, guint16 idx, guint8 subindex)
+dissect_object_mapping(struct profile *profile, struct object_mappings *mappings, proto_tree *epl_tree, tvbuff_t *tvb, guint32 framenum, gint offset, guint16 idx, guint8 subindex)
 {
 	proto_item *ti_obj, *ti_subobj, *psf_item;
 	proto_tree *psf_tree;
 	struct object_mapping map = {0};
 	struct object *mapping_obj;
-	int *ett;
 	struct subobject *mapping_subobj;
+	const struct pdo_subtree *subtree;
 	gboolean nosub = FALSE;
 
 	map.param.idx = idx;
@@ -4042,20 +5225,9 @@ dissect_object_mapping(struct profile *profile, wmem_array_t *mappings, proto_tr
 	proto_item_append_text(psf_item, " bits");
 	offset += 2;
 
-
-	/* TODO One could think of a better string here? */
-	if (nosub)
-		map.title = g_strdup_printf("PDO - %04X", map.pdo.idx);
-	else
-		map.title = g_strdup_printf("PDO - %04X:%02X", map.pdo.idx, map.pdo.subindex);
-
-
-	map.ett = -1;
-	ett = &map.ett;
-	/* We leak an ett entry every time we destruct a mapping
-	 * Not sure what to do about that
-	 */
-	proto_register_subtree_array(&ett, 1);
+	subtree = pdo_subtree_lookup_or_add(map.pdo.idx, map.pdo.subindex);
+	map.title = nosub ? subtree->nosub_title : subtree->title;
+	map.ett = subtree->ett;
 
 	add_object_mapping(mappings, &map);
 
@@ -4280,7 +5452,7 @@ dissect_epl_sdo_command_write_multiple_by_index(struct epl_convo *convo, proto_t
 			/* if the frame is a PDO Mapping and the subindex is bigger than 0x00 */
 			if((idx == EPL_SOD_PDO_TX_MAPP && subindex > 0x00) ||(idx == EPL_SOD_PDO_RX_MAPP && subindex > 0x00))
 			{
-				wmem_array_t *mappings = idx == EPL_SOD_PDO_TX_MAPP ? convo->TPDO : convo->RPDO;
+				struct object_mappings *mappings = idx == EPL_SOD_PDO_TX_MAPP ? convo->TPDO : convo->RPDO;
 
 				dissect_object_mapping(convo->profile, mappings, epl_tree, tvb, pinfo->num, dataoffset, idx, subindex);
 			}
@@ -4306,7 +5478,7 @@ dissect_epl_sdo_command_write_multiple_by_index(struct epl_convo *convo, proto_t
 }
 
 gint
-dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size)
+dissect_epl_sdo_command_read_by_index(struct epl_segmentation *segmentation, struct epl_convo *convo, proto_tree *epl_tree, tvbuff_t *tvb, packet_info *pinfo, gint offset, guint8 segmented, gboolean response, guint16 segment_size)
 {
 	gint size, payload_length;
 	guint16 idx = 0x00;
@@ -4341,6 +5513,12 @@ dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_t
 		psf_item = proto_tree_add_item(epl_tree, hf_epl_asnd_sdo_cmd_data_subindex, tvb, offset, 1, ENC_LITTLE_ENDIAN);
 		subobj = subobject_lookup(obj, subindex);
 
+		if (segmentation->info)
+		{
+			segmentation->info->idx = idx;
+			segmentation->info->subindex = subindex;
+		}
+
 		name = subobj ? subobj->info.name
 		              : val_to_str_ext_const((subindex|(idx<<16)), &sod_index_names, "User Defined");
 		proto_item_append_text(psf_item, " (%s)", name);
@@ -4354,24 +5532,41 @@ dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_t
 		col_append_fstr(pinfo->cinfo, COL_INFO, "/%s)",val_to_str_ext_const((subindex|(idx<<16)), &sod_index_names, "User Defined"));
 
 		/* Cache object for read in next response */
-		req = convo_read_req_set(convo, convo->seq_send);
-		req->idx = idx;
-		req->subindex = subindex;
-		if (obj) {
-			req->info = subobj ? &subobj->info : &obj->info;
-			req->index_name = obj->info.name;
-		} else {
-			req->info = NULL;
-			req->index_name = NULL;
+		if ((req = convo_read_req_set(convo, pinfo, convo->transaction_id, convo->seq_send)))
+		{
+			req->idx = idx;
+			req->subindex = subindex;
+			if (obj) {
+				req->info = subobj ? &subobj->info : &obj->info;
+				req->index_name = obj->info.name;
+			} else {
+				req->info = NULL;
+				req->index_name = NULL;
+			}
 		}
 	}
 	else
 	{
+		/* upload, accounted only */
+		if(stream_sdo_transfers && segmented > 0x01 && segment_size != 0)
+		{
+			struct sdo_transfer *transfer = epl_sdo_transfer_get(epl_capture_get(pinfo), segmentation->src, segmentation->dest, TRUE);
+
+			payload_length = tvb_reported_length_remaining(tvb, offset);
+			end_segment = segmented == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE;
+			dissect_epl_sdo_stream(epl_tree, tvb, pinfo, offset, payload_length,
+					sdo_stream_add(transfer, tvb, pinfo, offset, payload_length, 0, end_segment),
+					end_segment);
+		}
 		/* upload and no response */
-		if(segmented > 0x01 && segment_size != 0)
+		else if(segmented > 0x01 && segment_size != 0)
 		{
+			struct epl_capture *capture = epl_capture_get(pinfo);
+			struct sdo_transfer *transfer = epl_sdo_transfer_get(capture, segmentation->src, segmentation->dest, TRUE);
+			guint32 saved_frame = sdo_seq_frames_get(&transfer->frames, segmentation->recv, segmentation->send);
+
 			/* get the fragmentId */
-			fragmentId = (guint32)((((guint32)epl_segmentation.src)<<16)+epl_segmentation.dest);
+			fragmentId = (guint32)((((guint32)segmentation->src)<<16)+segmentation->dest);
 			/* set the fragmented flag */
 			pinfo->fragmented = TRUE;
 			/* get payloade size */
@@ -4380,32 +5575,32 @@ dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_t
 			if(segmented == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE)
 				end_segment = TRUE;
 
-			if(epl_asnd_sdo_reassembly_read.frame[epl_segmentation.recv][epl_segmentation.send] == 0x00 ||
-				epl_asnd_sdo_reassembly_read.frame[epl_segmentation.recv][epl_segmentation.send] == frame)
+			if(saved_frame == 0x00 || saved_frame == frame)
 			{
-				if (epl_asnd_sdo_reassembly_read.frame[epl_segmentation.recv][epl_segmentation.send] == 0x00)
-					count += 1;
+				if (saved_frame == 0x00)
+					transfer->seq += 1;
 				/* store the current frame and increase the counter */
-				epl_asnd_sdo_reassembly_read.frame[epl_segmentation.recv][epl_segmentation.send] = frame;
+				sdo_seq_frames_set(&transfer->frames, segmentation->recv, segmentation->send, frame);
+				saved_frame = frame;
 
 				/* add the frame to reassembly_table */
-				if (first_read)
+				if (transfer->first)
 				{
-					frag_msg = fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
+					frag_msg = fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
 							fragmentId, NULL, 0, payload_length, end_segment ? FALSE : TRUE );
-					fragment_add_seq_offset(&epl_reassembly_table, pinfo, fragmentId, NULL, count);
+					fragment_add_seq_offset(&capture->reassembly, pinfo, fragmentId, NULL, transfer->seq);
 
-					first_read = FALSE;
+					transfer->first = FALSE;
 				}
 				else
 				{
-					frag_msg = fragment_add_seq_check(&epl_reassembly_table, tvb, offset, pinfo,
-							fragmentId, NULL, count, payload_length, end_segment ? FALSE : TRUE );
+					frag_msg = fragment_add_seq_check(&capture->reassembly, tvb, offset, pinfo,
+							fragmentId, NULL, transfer->seq, payload_length, end_segment ? FALSE : TRUE );
 				}
 			}
 
 			/* if the reassembly_table is not Null and the frame stored is the same as the current frame */
-			if(frag_msg != NULL && (epl_asnd_sdo_reassembly_read.frame[epl_segmentation.recv][epl_segmentation.send] == frame))
+			if(frag_msg != NULL && saved_frame == frame)
 			{
 				if(end_segment || payload_length > 0)
 				{
@@ -4419,7 +5614,7 @@ dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_t
 					if (frag_msg->reassembled_in == frame)
 						col_append_str(pinfo->cinfo, COL_INFO, " (Message Reassembled)" );
 					/* reset memory */
-					memset(&epl_asnd_sdo_reassembly_read.frame[epl_segmentation.recv], 0, sizeof(guint32) * EPL_MAX_SEQUENCE);
+					sdo_seq_frames_reset(&transfer->frames);
 				}
 				else
 				{
@@ -4430,8 +5625,8 @@ dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_t
 					process_reassembled_data(tvb, 0, pinfo, "Reassembled Message", frag_msg, &epl_frag_items, NULL, payload_tree );
 				}
 
-				first_read = TRUE;
-				count = 0;
+				transfer->first = TRUE;
+				transfer->seq = 0;
 			}
 		}
 		/* response */
@@ -4441,8 +5636,15 @@ dissect_epl_sdo_command_read_by_index(struct epl_convo *convo, proto_tree *epl_t
 
 		/* Did we register the read req? */
 
-		if ((req = convo_read_req_get(convo, pinfo, convo->seq_send))) {
+		if ((req = convo_read_req_get(convo, pinfo, convo->transaction_id,
+				segmented == EPL_ASND_SDO_CMD_SEGMENTATION_EPEDITED_TRANSFER
+				|| segmented == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE))) {
 			proto_item *ti;
+			if (segmentation->info)
+			{
+				segmentation->info->idx = req->idx;
+				segmentation->info->subindex = req->subindex;
+			}
 			ti = proto_tree_add_uint_format_value(epl_tree, hf_epl_asnd_sdo_cmd_data_index, tvb, 0, 0, req->idx, "%04X", req->idx);
 			PROTO_ITEM_SET_GENERATED(ti);
 			if (req->info)
@@ -4543,43 +5745,204 @@ static uat_field_t nodeid_profile_list_uats_flds[] = {
 
 static gboolean epl_profile_uat_fld_fileopen_check_cb(void *, const char *path, guint len, const void *, const void *, char **err);
 
-struct profile *profile_load(wmem_allocator_t *allocator, const char *path)
-{
-	struct profile *profile = NULL;
+#if GLIB_CHECK_VERSION(2, 36, 0)
+#define EPL_PROFILE_LOADERS g_get_num_processors()
+#else
+#define EPL_PROFILE_LOADERS 1
+#endif
+
+/* Loading a profile is split in three, so the UAT tables can parse
+ * their profiles on a thread pool: begin and end run on the main thread
+ * in row order, while run only touches the profile's own pool.
+ * Rows naming a file that is already parsed, or about to be for an
+ * earlier row, don't parse at all but share that profile
+ */
+struct profile_job {
+	const char *path;
+	char *file;
+	wmem_allocator_t *allocator;
+	struct profile *profile;       /* to be parsed by this job */
+	struct profile *shared;        /* parsed before, already referenced */
+	struct profile_job *leader;    /* earlier job parsing the same file */
+	char *cache_dir;               /* NULL if profiles aren't cached */
+	struct profile *result;
 	char *err;
-	if (!epl_profile_uat_fld_fileopen_check_cb(NULL, path, strlen(path), NULL, NULL, &err))
+	gboolean loaded;
+};
+
+static char *
+profile_canonical_path(const char *path)
+{
+#if GLIB_CHECK_VERSION(2, 58, 0)
+	return g_canonicalize_filename(path, NULL);
+#else
+	return g_strdup(path);
+#endif
+}
+
+static void
+profile_job_begin(struct profile_job *job, wmem_allocator_t *allocator, const char *path, struct profile_job *earlier, guint n_earlier)
+{
+	struct profile *shared;
+	guint i;
+
+	memset(job, 0, sizeof *job);
+	job->path      = path;
+	job->allocator = allocator;
+
+	if (!epl_profile_uat_fld_fileopen_check_cb(NULL, path, (guint)strlen(path), NULL, NULL, &job->err))
+		return;
+
+	job->file = profile_canonical_path(path);
+
+	/* Referenced right away, so it survives the rows being dropped */
+	shared = (struct profile*)wmem_map_lookup(epl_profiles_by_file, job->file);
+	if (shared && profile_stamp_matches(&shared->stamp, job->file))
 	{
-		report_failure("%s", err);
-		g_free(err);
-		return NULL;
+		job->shared = shared;
+		shared->refcount++;
+		return;
 	}
 
-	if (g_str_has_suffix(path, ".eds"))
+	for (i = 0; i < n_earlier; i++)
+	{
+		if (earlier[i].file && strcmp(earlier[i].file, job->file) == 0)
+		{
+			job->leader = earlier[i].leader ? earlier[i].leader : &earlier[i];
+			return;
+		}
+	}
+
+	job->profile = profile_new(allocator);
+	if (cache_profiles)
+		job->cache_dir = profile_cache_dir();
+}
+
+static void
+profile_job_run(gpointer data, gpointer user_data _U_)
+{
+	struct profile_job *job = (struct profile_job*)data;
+	struct profile *profile = job->profile;
+
+	if (!profile)
+		return;
+
+	/* taken before parsing, so a change while parsing is noticed later */
+	if (!profile_stamp_get(&profile->stamp, job->path))
+		return;
+
+	if (job->cache_dir && profile_cache_load(job->cache_dir, profile, job->path, &profile->stamp))
 	{
-		profile = profile_new(allocator);
-		if (!eds_load(profile, path))
-			profile_del(profile);
+		job->loaded = TRUE;
+		return;
+	}
+
+	if (g_str_has_suffix(job->path, ".eds"))
+	{
+		job->loaded = eds_load(profile, job->path) != NULL;
 	}
 #if HAVE_LIBXML2
-	else if (g_str_has_suffix(path, ".xdd") || g_str_has_suffix(path, ".xdc"))
+	else if (g_str_has_suffix(job->path, ".xdd") || g_str_has_suffix(job->path, ".xdc"))
 	{
-		profile = profile_new(allocator);
-		if (!xdd_load(profile, path))
-			profile_del(profile);
+		job->loaded = xdd_load(profile, job->path) != NULL;
 	}
 #endif
-	if (!profile)
-		report_failure("Profile '%s' couldn't be parsed", path);
+
+	if (job->loaded && job->cache_dir)
+		profile_cache_store(job->cache_dir, profile, job->path, &profile->stamp);
+}
+
+static struct profile *
+profile_job_end(struct profile_job *job)
+{
+	struct profile *shared = NULL, *profile = NULL;
+
+	if (job->err)
+	{
+		report_failure("%s", job->err);
+		g_free(job->err);
+	}
+	else if (job->shared)
+	{
+		shared = job->shared;
+		profile = profile_ref(job->allocator, shared);
+		profile_unref(shared); /* the reference taken in begin */
+	}
+	else if (job->leader)
+	{
+		if ((shared = job->leader->result))
+			profile = profile_ref(job->allocator, shared);
+		else
+			report_failure("Profile '%s' couldn't be parsed", job->path);
+	}
+	else if (!job->loaded)
+	{
+		profile_del(job->profile);
+		report_failure("Profile '%s' couldn't be parsed", job->path);
+	}
+	else
+	{
+		shared = job->profile;
+		profile_object_mappings_build(shared);
+		/* compiled here, so sessions sharing the mappings only read them */
+		object_mappings_compile(shared->RPDO);
+		object_mappings_compile(shared->TPDO);
+
+		shared->file = wmem_strdup(shared->scope, job->file);
+		wmem_map_insert(epl_profiles_by_file, shared->file, shared);
+		profile = profile_ref(job->allocator, shared);
+	}
+
+	g_free(job->file);
+	g_free(job->cache_dir);
+	job->file = NULL;
+	job->cache_dir = NULL;
+	job->result = shared;
 
 	return profile;
 }
 
+static void
+profile_jobs_run(struct profile_job *jobs, guint count)
+{
+	GThreadPool *pool = NULL;
+	guint i, threads;
+
+	threads = MIN(count, (guint)EPL_PROFILE_LOADERS);
+	if (threads > 1)
+		pool = g_thread_pool_new(profile_job_run, NULL, threads, FALSE, NULL);
+
+	for (i = 0; i < count; i++)
+	{
+		if (!pool)
+			profile_job_run(&jobs[i], NULL);
+		else if (jobs[i].profile)
+			g_thread_pool_push(pool, &jobs[i], NULL);
+	}
+
+	/* waits for all jobs to finish */
+	if (pool)
+		g_thread_pool_free(pool, FALSE, TRUE);
+}
+
+struct profile *profile_load(wmem_allocator_t *allocator, const char *path)
+{
+	struct profile_job job;
+
+	profile_job_begin(&job, allocator, path, NULL, 0);
+	profile_job_run(&job, NULL);
+	return profile_job_end(&job);
+}
+
 void apply_prefs(void)
 {
+	struct profile *old;
 	if (epl_default_profile_path && *epl_default_profile_path)
 	{
-		profile_del(epl_default_profile);
+		/* dropped afterwards, so an unchanged profile is kept */
+		old = epl_default_profile;
 		epl_default_profile = profile_load(wmem_epan_scope(), epl_default_profile_path);
+		profile_del(old);
 		epl_default_profile_path = NULL;
 		/* TODO we could use something like UAT_AFFECTS_DISSECTION */
 	}
@@ -5397,6 +6760,34 @@ proto_register_epl(void)
 			{ "Reassembled", "epl-xdd.asnd.sdo.cmd.reassembled",
 				FT_UINT8, BASE_DEC, NULL, 0x00, NULL, HFILL }
 		},
+		{ &hf_epl_asnd_sdo_cmd_stream,
+			{ "Stream", "epl-xdd.asnd.sdo.cmd.stream",
+				FT_NONE, BASE_NONE, NULL, 0x00, NULL, HFILL }
+		},
+		{ &hf_epl_asnd_sdo_cmd_stream_size,
+			{ "Announced size", "epl-xdd.asnd.sdo.cmd.stream.size",
+				FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+		},
+		{ &hf_epl_asnd_sdo_cmd_stream_length,
+			{ "Streamed length", "epl-xdd.asnd.sdo.cmd.stream.length",
+				FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+		},
+		{ &hf_epl_asnd_sdo_cmd_stream_segments,
+			{ "Streamed segments", "epl-xdd.asnd.sdo.cmd.stream.segments",
+				FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+		},
+		{ &hf_epl_asnd_sdo_cmd_stream_crc,
+			{ "CRC-32 so far", "epl-xdd.asnd.sdo.cmd.stream.crc",
+				FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL }
+		},
+		{ &hf_epl_asnd_sdo_cmd_stream_cycles,
+			{ "Cycles", "epl-xdd.asnd.sdo.cmd.stream.cycles",
+				FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+		},
+		{ &hf_epl_asnd_sdo_cmd_stream_bytes_per_cycle,
+			{ "Bytes per cycle", "epl-xdd.asnd.sdo.cmd.stream.bytes_per_cycle",
+				FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+		},
 		{ &hf_epl_reassembled_in,
 			{ "Reassembled in", "epl-xdd.asnd.sdo.cmd.reassembled.in",
 				FT_FRAMENUM, BASE_NONE, NULL, 0x00, NULL, HFILL }
@@ -5569,6 +6960,7 @@ proto_register_epl(void)
 		&ett_epl_fragment,
 		&ett_epl_fragments,
 		&ett_epl_asnd_sdo_data_reassembled,
+		&ett_epl_asnd_sdo_stream,
 		&ett_epl_asnd_nmt_dna,
 	};
 
@@ -5635,6 +7027,12 @@ proto_register_epl(void)
 	prefs_register_bool_preference(epl_module, "show_pdo_meta_info", "Show life times and origin PDO Tx/Rx params for PDO entries",
 		"For analysis purposes one might want to see how long the current mapping has been active for and what OD write caused it", &show_pdo_meta_info);
 
+	prefs_register_bool_preference(epl_module, "stream_sdo_transfers", "Stream segmented SDO transfers",
+		"Instead of reassembling segmented SDO transfers, only account their length, CRC-32 and throughput. Use this for large domain transfers like firmware downloads", &stream_sdo_transfers);
+
+	prefs_register_bool_preference(epl_module, "cache_profiles", "Cache parsed profiles",
+		"Keep a compiled copy of every loaded EDS" IF_LIBXML("/XDD/XDC") " in the personal configuration directory and load that instead, until the profile file changes", &cache_profiles);
+
 #ifdef HAVE_LIBXML2
 	prefs_register_bool_preference(epl_module, "read_xdc_for_mappings", "Read ObjectMappings from XDC",
 		"If you want to parse the defaultValue (XDD) and actualValue (XDC) attributes for ObjectMappings in order to detect default PDO mappings, which may not be exchanged over SDO ", &read_xdc_for_mappings);
@@ -5644,6 +7042,10 @@ proto_register_epl(void)
 	epl_profiles_by_device = wmem_map_new(wmem_epan_scope(), epl_g_int16_hash, epl_g_int16_equal);
 	epl_profiles_by_nodeid = wmem_map_new(wmem_epan_scope(), epl_g_int8_hash, epl_g_int8_equal);
 	epl_profiles_by_address = wmem_map_new(wmem_epan_scope(), epl_address_hash, epl_address_equal);
+	epl_profiles_by_file = wmem_map_new(wmem_epan_scope(), g_str_hash, g_str_equal);
+
+	epl_pdo_subtrees = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
+	epl_captures = g_hash_table_new(g_direct_hash, g_direct_equal);
 
 #ifdef HAVE_LIBXML2
 	xdd_init();
@@ -5699,7 +7101,10 @@ proto_register_epl(void)
 			);
 
 	/* tap-registration */
-	/*  epl_tap = register_tap("epl-xdd");*/
+	epl_tap = register_tap("epl-xdd");
+	epl_sdo_tap = register_tap("epl-xdd.sdo");
+	epl_sdo_stats_register();
+	epl_cycle_stats_register();
 
 	puts("Loading EPL+XDD plugin (built on " __DATE__ " " __TIME__ ")");
 }
@@ -5713,8 +7118,6 @@ proto_reg_handoff_epl(void)
 	dissector_add_uint("udp.port", UDP_PORT_EPL, epl_udp_handle);
 
 	/* register frame init routine */
-	register_init_routine( setup_dissector );
-	register_cleanup_routine( cleanup_dissector );
 }
 
 
@@ -5802,6 +7205,15 @@ device_profile_parse_uat(void)
 {
 	guint i;
 	struct profile *profile = NULL;
+	struct profile_job *jobs;
+
+	/* Begun before dropping the old rows, so unchanged profiles they
+	 * share are kept instead of parsed again
+	 */
+	jobs = g_new(struct profile_job, ndevice_profile_uat);
+	for (i = 0; i < ndevice_profile_uat; i++)
+		profile_job_begin(&jobs[i], wmem_epan_scope(), device_profile_list_uats[i].path, jobs, i);
+
 	wmem_map_foreach(epl_profiles_by_device, drop_profiles, NULL);
 
 	/* PDO Mappings can have dangling pointers after a profile change
@@ -5810,26 +7222,20 @@ device_profile_parse_uat(void)
 	 * done automatically.
 	 */
 
-	if (pdo_mapping_scope)
-		wmem_free_all(pdo_mapping_scope);
+	epl_captures_free_mappings();
+
+	profile_jobs_run(jobs, ndevice_profile_uat);
 
 	for (i = 0; i < ndevice_profile_uat; i++)
 	{
 		struct device_profile_uat_assoc *uat = &(device_profile_list_uats[i]);
+		struct profile *profile_head;
 
-		profile = wmem_map_lookup(
-			epl_profiles_by_device,
-			&uat->DeviceType
-		);
-
-		if (!profile)
-			profile = profile_load(wmem_epan_scope(), uat->path);
-
-		if (!profile)
+		if (!(profile = profile_job_end(&jobs[i])))
 			continue;
 
-		struct profile *profile_head;
-		if ((profile_head = wmem_map_lookup(epl_profiles_by_device, &profile->id)))
+		/* rows for the same DeviceType are chained, see epl_update_convo_cn_profile */
+		if ((profile_head = wmem_map_lookup(epl_profiles_by_device, &uat->DeviceType)))
 		{
 			wmem_map_remove(epl_profiles_by_device, &profile_head->id);
 			profile->next = profile_head;
@@ -5845,6 +7251,8 @@ device_profile_parse_uat(void)
 
 		EPL_INFO("Loading %s\n", profile->path);
 	}
+
+	g_free(jobs);
 }
 
 static gboolean
@@ -5874,11 +7282,40 @@ device_profile_uat_copy_cb(void *dst_, const void *src_, size_t len _U_)
 	return dst;
 }
 
+/* Only the first row for a node is used */
+static gboolean
+nodeid_profile_uat_is_duplicate(guint row)
+{
+	const struct nodeid_profile_uat_assoc *uat = &nodeid_profile_list_uats[row];
+	guint i;
+
+	for (i = 0; i < row; i++)
+	{
+		const struct nodeid_profile_uat_assoc *prev = &nodeid_profile_list_uats[i];
+		if (prev->is_nodeid != uat->is_nodeid)
+			continue;
+		if (uat->is_nodeid ? prev->node.id == uat->node.id : addresses_equal(&prev->node.address, &uat->node.address))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
 static void
 nodeid_profile_parse_uat(void)
 {
 	guint i;
 	struct profile *profile = NULL;
+	struct profile_job *jobs;
+
+	/* Begun before dropping the old rows, see device_profile_parse_uat */
+	jobs = g_new0(struct profile_job, nnodeid_profile_uat);
+	for (i = 0; i < nnodeid_profile_uat; i++)
+	{
+		if (!nodeid_profile_uat_is_duplicate(i))
+			profile_job_begin(&jobs[i], wmem_epan_scope(), nodeid_profile_list_uats[i].path, jobs, i);
+	}
+
 	wmem_map_foreach(epl_profiles_by_nodeid, drop_profiles, NULL);
 	wmem_map_foreach(epl_profiles_by_address, drop_profiles, NULL);
 
@@ -5888,22 +7325,18 @@ nodeid_profile_parse_uat(void)
 	 * done automatically.
 	 */
 
-	if (pdo_mapping_scope)
-		wmem_free_all(pdo_mapping_scope);
+	epl_captures_free_mappings();
+
+	profile_jobs_run(jobs, nnodeid_profile_uat);
 
 	for (i = 0; i < nnodeid_profile_uat; i++)
 	{
 		struct nodeid_profile_uat_assoc *uat = &(nodeid_profile_list_uats[i]);
 
-		profile = wmem_map_lookup(
-			uat->is_nodeid ? epl_profiles_by_nodeid : epl_profiles_by_address,
-			&uat->node
-		);
-
-		if (!profile)
-			profile = profile_load(wmem_epan_scope(), uat->path);
+		if (!jobs[i].path)
+			continue;
 
-		if(!profile)
+		if (!(profile = profile_job_end(&jobs[i])))
 			continue;
 
 		if (uat->is_nodeid)
@@ -5925,6 +7358,8 @@ nodeid_profile_parse_uat(void)
 		}
 		EPL_INFO("Loading %s\n", profile->path);
 	}
+
+	g_free(jobs);
 }
 
 
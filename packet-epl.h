@@ -27,6 +27,7 @@
 
 #include <glib.h>
 #include <epan/address.h>
+#include <epan/packet_info.h>
 #include <epan/wmem/wmem.h>
 #include "wmem_iarray.h"
 
@@ -40,6 +41,17 @@ guint epl_g_int16_hash(gconstpointer v);
 
 struct epl_datatype;
 const struct epl_datatype *epl_type_to_hf(const char *name);
+const char *epl_type_name(const struct epl_datatype *type);
+
+struct object_mappings;
+
+/* Identifies the content of a profile file */
+struct profile_stamp {
+	guint64 size;
+	gint64 mtime;
+	gboolean hashed; /* sha1 is only computed when needed */
+	guint8 sha1[20];
+};
 
 struct profile {
 	guint16 id;
@@ -57,10 +69,22 @@ struct profile {
 	char *path;
 	void *data;
 	guint cb_id;
-	wmem_array_t *TPDO; /* CN->MN */
-	wmem_array_t *RPDO; /* MN->CN */
+	struct object_mappings *TPDO; /* CN->MN */
+	struct object_mappings *RPDO; /* MN->CN */
+	wmem_array_t *default_mappings; /* struct profile_mapping, as read */
 
 	struct profile *next;
+
+	/* UAT rows naming the same file share one parsed profile. A row's
+	 * profile copies the fields above from the shared one, but owns
+	 * none of what they point to
+	 */
+	struct profile *shared; /* NULL if this is the parsed profile */
+	guint refcount;         /* rows referring to this parsed profile */
+	char *file;             /* canonical path, if registered */
+	struct profile_stamp stamp;
+
+	struct profile_cache *cache; /* objects not built yet, if loaded from the cache */
 };
 
 #define OD_ENTRY_NO_SUBINDICES 7
@@ -92,12 +116,123 @@ struct object {
 };
 
 
+/* An ObjectMapping default value as found in the profile */
+struct profile_mapping {
+	guint16 idx;
+	guint8 subindex;
+	guint64 value;
+};
+
 struct object *profile_object_add(struct profile *profile, guint16 idx);
 struct object *profile_object_lookup_or_add(struct profile *profile, guint16 idx);
 gboolean profile_object_mapping_add(struct profile *profile, guint16 idx, guint8 subindex, guint64 mapping);
 gboolean profile_object_mappings_update(struct profile *profile);
 struct object * object_lookup(struct profile *profile, guint16 idx);
 
+/* A PReq/PRes payload is unpacked into one of these per frame. It's
+ * attached to the packet, so taps can use the values without decoding
+ * the payload again
+ */
+enum epl_pdo_value_kind {
+	EPL_PDO_VALUE_NONE, /* not a scalar, see the tree for it */
+	EPL_PDO_VALUE_UNSIGNED,
+	EPL_PDO_VALUE_SIGNED, /* value is sign extended */
+	EPL_PDO_VALUE_BOOLEAN
+};
+
+struct epl_pdo_value {
+	guint16 idx;
+	guint8 subindex;
+	guint8 kind;
+	guint16 bit_offset;
+	guint16 no_of_bits;
+	guint64 value;
+};
+
+struct epl_pdo_values {
+	guint8 msgType;
+	guint count;
+	struct epl_pdo_value *objs;
+};
+
+const struct epl_pdo_values *epl_get_pdo_values(packet_info *pinfo);
+
+/* EPL message types */
+#define EPL_SOC     0x01
+#define EPL_PREQ    0x03
+#define EPL_PRES    0x04
+#define EPL_SOA     0x05
+#define EPL_ASND    0x06
+#define EPL_AMNI    0x07
+#define EPL_AINV    0x0D
+
+/* SDO command layer */
+#define EPL_ASND_SDO_CMD_SEGMENTATION_EPEDITED_TRANSFER     0
+#define EPL_ASND_SDO_CMD_SEGMENTATION_INITIATE_TRANSFER     1
+#define EPL_ASND_SDO_CMD_SEGMENTATION_SEGMENT               2
+#define EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE     3
+
+#define EPL_ASND_SDO_COMMAND_NOT_IN_LIST                        0x00
+#define EPL_ASND_SDO_COMMAND_WRITE_BY_INDEX                     0x01
+#define EPL_ASND_SDO_COMMAND_READ_BY_INDEX                      0x02
+#define EPL_ASND_SDO_COMMAND_WRITE_ALL_BY_INDEX                 0x03
+#define EPL_ASND_SDO_COMMAND_READ_ALL_BY_INDEX                  0x04
+#define EPL_ASND_SDO_COMMAND_WRITE_BY_NAME                      0x05
+#define EPL_ASND_SDO_COMMAND_READ_BY_NAME                       0x06
+#define EPL_ASND_SDO_COMMAND_FILE_WRITE                         0x20
+#define EPL_ASND_SDO_COMMAND_FILE_READ                          0x21
+#define EPL_ASND_SDO_COMMAND_WRITE_MULTIPLE_PARAMETER_BY_INDEX  0x31
+#define EPL_ASND_SDO_COMMAND_READ_MULTIPLE_PARAMETER_BY_INDEX   0x32
+#define EPL_ASND_SDO_COMMAND_MAXIMUM_SEGMENT_SIZE               0x70
+#define EPL_ASND_SDO_COMMAND_LINK_NAME_TO_INDEX                 0x71
+
+/* Queued on the "epl-xdd.sdo" tap for every SDO frame.
+ * The command layer fields are only valid if has_command is set
+ */
+struct epl_sdo_info {
+	guint8 src, dest;
+	guint8 node;            /* the CN side of the connection */
+	guint8 seq_recv, seq_send;
+	gboolean duplicate;
+	gboolean retransmission;
+
+	gboolean has_command;
+	gboolean response, abort;
+	guint8 command_id;
+	guint8 transaction_id;
+	guint8 segmentation;
+	guint16 idx;            /* 0 if not known in this frame */
+	guint8 subindex;
+	guint16 length;         /* command layer payload */
+
+	guint32 cycle;          /* SoCs seen before this frame */
+};
+
+/* Queued on the "epl-xdd" tap for every EPL PDU. It lives in the
+ * packet scope, so listeners copy what they want to keep.
+ * Fields not carried by the frame's message type are 0
+ */
+struct epl_info {
+	guint8 mtyp;
+	guint8 src, dest;
+
+	gboolean has_nmt_state; /* PRes, SoA, AInv, Ident-/StatusResponse */
+	guint8 nmt_state;
+
+	/* PReq, PRes */
+	guint8 pdo_version;
+	guint16 payload_size;
+	const struct epl_pdo_values *pdo;
+
+	/* SoC */
+	nstime_t nettime;
+	guint64 relativetime;
+
+	/* ASnd SDO */
+	gboolean has_sdo;
+	struct epl_sdo_info sdo;
+};
+
 #define CHECK_OVERLAP_ENDS(x1, x2, y1, y2) ((x1) < (y2) && (y1) < (x2))
 #define CHECK_OVERLAP_LENGTH(x, x_len, y, y_len) \
 	CHECK_OVERLAP_ENDS((x), (x) + (x_len), (y), (y) + (y_len))
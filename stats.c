@@ -0,0 +1,733 @@
+/* stats.c
+ * Statistics for Ethernet POWERLINK, fed by the EPL+XDD dissector's taps
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include "stats.h"
+
+#include "packet-epl.h"
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <wsutil/nstime.h>
+#include <wsutil/report_err.h>
+
+/* SDO transfer statistics
+ *
+ * A transfer starts with an expedited or initiating request and ends
+ * with the response that completes it or with an abort from either
+ * side. Requests and responses are matched by transaction id per CN.
+ * Sequence layer events (duplicates, retransmission requests) carry no
+ * transaction id, they count towards the transfer last active on their
+ * connection.
+ */
+
+#define SDO_STATS_CLI "epl-xdd,sdo"
+
+struct sdo_stats_row {
+	guint32 transfers;
+	guint32 aborts;
+	guint32 segments;
+	guint32 duplicates;
+	guint32 retransmissions;
+	guint64 bytes;
+	guint64 cycles;
+	/* in milliseconds */
+	double latency_min, latency_max, latency_sum;
+};
+
+struct sdo_stats_transfer {
+	gboolean open;
+	guint8 command_id;
+	guint16 idx;
+	guint8 subindex;
+	nstime_t start;
+	guint32 first_cycle, last_cycle;
+	guint32 segments;
+	guint32 duplicates;
+	guint32 retransmissions;
+	guint32 bytes;
+};
+
+struct sdo_stats_node {
+	struct sdo_stats_row row;
+	struct sdo_stats_transfer transfers[256]; /* by transaction id */
+	struct sdo_stats_transfer *last;
+};
+
+struct sdo_stats {
+	char *filter;
+	struct sdo_stats_node *nodes[256];
+	GHashTable *by_index; /* idx -> struct sdo_stats_row */
+};
+
+static struct sdo_stats_node *
+sdo_stats_node_get(struct sdo_stats *stats, guint8 node)
+{
+	if (!stats->nodes[node])
+		stats->nodes[node] = g_new0(struct sdo_stats_node, 1);
+
+	return stats->nodes[node];
+}
+
+static struct sdo_stats_row *
+sdo_stats_index_get(struct sdo_stats *stats, guint16 idx)
+{
+	struct sdo_stats_row *row = (struct sdo_stats_row*)g_hash_table_lookup(stats->by_index, GUINT_TO_POINTER(idx));
+	if (!row)
+	{
+		row = g_new0(struct sdo_stats_row, 1);
+		g_hash_table_insert(stats->by_index, GUINT_TO_POINTER(idx), row);
+	}
+	return row;
+}
+
+/* Object data in this frame, without the command layer's own fields.
+ * Writes carry their data in requests, reads in responses
+ */
+static guint32
+sdo_stats_data_length(const struct epl_sdo_info *info)
+{
+	guint32 header = 0;
+	gboolean read = info->command_id == EPL_ASND_SDO_COMMAND_READ_BY_INDEX;
+
+	if (info->abort || (read ? !info->response : info->response))
+		return 0;
+
+	/* index, subindex and a reserved byte */
+	if (!read && info->segmentation <= EPL_ASND_SDO_CMD_SEGMENTATION_INITIATE_TRANSFER)
+		header += 4;
+	/* data size */
+	if (info->segmentation == EPL_ASND_SDO_CMD_SEGMENTATION_INITIATE_TRANSFER)
+		header += 4;
+
+	return info->length > header ? info->length - header : 0;
+}
+
+static void
+sdo_stats_row_add(struct sdo_stats_row *row, const struct sdo_stats_transfer *transfer, gboolean aborted, double latency)
+{
+	if (!row->transfers || latency < row->latency_min)
+		row->latency_min = latency;
+	if (latency > row->latency_max)
+		row->latency_max = latency;
+	row->latency_sum += latency;
+
+	row->transfers++;
+	if (aborted)
+		row->aborts++;
+	row->segments += transfer->segments;
+	row->duplicates += transfer->duplicates;
+	row->retransmissions += transfer->retransmissions;
+	row->bytes += transfer->bytes;
+	row->cycles += transfer->last_cycle - transfer->first_cycle + 1;
+}
+
+static void
+sdo_stats_transfer_start(struct sdo_stats_transfer *transfer, const struct epl_sdo_info *info, packet_info *pinfo)
+{
+	memset(transfer, 0, sizeof *transfer);
+	transfer->open = TRUE;
+	transfer->command_id = info->command_id;
+	transfer->idx = info->idx;
+	transfer->subindex = info->subindex;
+	transfer->start = pinfo->abs_ts;
+	transfer->first_cycle = transfer->last_cycle = info->cycle;
+}
+
+static void
+sdo_stats_transfer_end(struct sdo_stats *stats, struct sdo_stats_node *node, struct sdo_stats_transfer *transfer, packet_info *pinfo, gboolean aborted)
+{
+	nstime_t delta;
+	double latency;
+
+	nstime_delta(&delta, &pinfo->abs_ts, &transfer->start);
+	latency = nstime_to_msec(&delta);
+
+	sdo_stats_row_add(&node->row, transfer, aborted, latency);
+	sdo_stats_row_add(sdo_stats_index_get(stats, transfer->idx), transfer, aborted, latency);
+
+	transfer->open = FALSE;
+}
+
+static gboolean
+sdo_stats_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+	struct sdo_stats *stats = (struct sdo_stats*)tapdata;
+	const struct epl_sdo_info *info = (const struct epl_sdo_info*)data;
+	struct sdo_stats_node *node = sdo_stats_node_get(stats, info->node);
+	struct sdo_stats_transfer *transfer;
+
+	if (!info->has_command)
+	{
+		transfer = node->last;
+	}
+	else
+	{
+		transfer = &node->transfers[info->transaction_id];
+
+		if (!info->response && !info->duplicate && !info->abort
+		&& info->segmentation <= EPL_ASND_SDO_CMD_SEGMENTATION_INITIATE_TRANSFER)
+			sdo_stats_transfer_start(transfer, info, pinfo);
+	}
+
+	if (!transfer || !transfer->open)
+		return FALSE;
+
+	node->last = transfer;
+
+	if (info->duplicate)
+		transfer->duplicates++;
+	if (info->retransmission)
+		transfer->retransmissions++;
+
+	/* duplicates were accounted the first time around */
+	if (!info->has_command || info->duplicate)
+		return TRUE;
+
+	if (!transfer->idx)
+	{
+		transfer->idx = info->idx;
+		transfer->subindex = info->subindex;
+	}
+	transfer->last_cycle = info->cycle;
+
+	if (sdo_stats_data_length(info) || info->segmentation == EPL_ASND_SDO_CMD_SEGMENTATION_SEGMENT)
+	{
+		transfer->segments++;
+		transfer->bytes += sdo_stats_data_length(info);
+	}
+
+	if (info->abort)
+		sdo_stats_transfer_end(stats, node, transfer, pinfo, TRUE);
+	else if (info->response && (info->segmentation == EPL_ASND_SDO_CMD_SEGMENTATION_EPEDITED_TRANSFER
+	                         || info->segmentation == EPL_ASND_SDO_CMD_SEGMENTATION_TRANSFER_COMPLETE))
+		sdo_stats_transfer_end(stats, node, transfer, pinfo, FALSE);
+
+	return TRUE;
+}
+
+static void
+sdo_stats_reset(void *tapdata)
+{
+	struct sdo_stats *stats = (struct sdo_stats*)tapdata;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(stats->nodes); i++)
+	{
+		g_free(stats->nodes[i]);
+		stats->nodes[i] = NULL;
+	}
+	g_hash_table_remove_all(stats->by_index);
+}
+
+static void
+sdo_stats_print_row(const char *label, const struct sdo_stats_row *row)
+{
+	printf("%-8s %9u %6u %8u %10" G_GINT64_MODIFIER "u %6u %7u %8.3f %8.3f %8.3f %11.1f\n",
+			label, row->transfers, row->aborts, row->segments, row->bytes,
+			row->duplicates, row->retransmissions,
+			row->latency_min, row->latency_sum / row->transfers, row->latency_max,
+			row->cycles ? (double)row->bytes / row->cycles : 0.0);
+}
+
+static void
+sdo_stats_print_header(const char *label)
+{
+	printf("%-8s %9s %6s %8s %10s %6s %7s %8s %8s %8s %11s\n",
+			label, "Transfers", "Aborts", "Segments", "Bytes", "Dups", "Retrans",
+			"Min[ms]", "Avg[ms]", "Max[ms]", "Bytes/cycle");
+}
+
+static gint
+sdo_stats_index_cmp(gconstpointer a, gconstpointer b)
+{
+	return (gint)GPOINTER_TO_UINT(a) - (gint)GPOINTER_TO_UINT(b);
+}
+
+static void
+sdo_stats_draw(void *tapdata)
+{
+	struct sdo_stats *stats = (struct sdo_stats*)tapdata;
+	GList *indices, *it;
+	char label[16];
+	guint i;
+
+	printf("\n");
+	printf("==========================================================================================\n");
+	printf("EPL SDO Transfer Statistics\n");
+	printf("Filter: %s\n", stats->filter ? stats->filter : "");
+	printf("Latency is from the first request to the response completing the transfer.\n");
+	printf("Bytes are object data, a cycle is one SoC period.\n");
+
+	printf("\nPer CN:\n");
+	sdo_stats_print_header("Node");
+	for (i = 0; i < G_N_ELEMENTS(stats->nodes); i++)
+	{
+		if (!stats->nodes[i] || !stats->nodes[i]->row.transfers)
+			continue;
+		g_snprintf(label, sizeof label, "%u", i);
+		sdo_stats_print_row(label, &stats->nodes[i]->row);
+	}
+
+	printf("\nPer object index:\n");
+	sdo_stats_print_header("Index");
+	indices = g_list_sort(g_hash_table_get_keys(stats->by_index), sdo_stats_index_cmp);
+	for (it = indices; it; it = it->next)
+	{
+		guint idx = GPOINTER_TO_UINT(it->data);
+		if (idx)
+			g_snprintf(label, sizeof label, "0x%04X", idx);
+		else
+			g_strlcpy(label, "unknown", sizeof label);
+		sdo_stats_print_row(label, (const struct sdo_stats_row*)g_hash_table_lookup(stats->by_index, it->data));
+	}
+	g_list_free(indices);
+
+	printf("==========================================================================================\n");
+}
+
+static void
+sdo_stats_init(const char *opt_arg, void *userdata _U_)
+{
+	struct sdo_stats *stats;
+	const char *filter = NULL;
+	GString *error;
+
+	if (g_str_has_prefix(opt_arg, SDO_STATS_CLI ","))
+		filter = opt_arg + strlen(SDO_STATS_CLI ",");
+
+	stats = g_new0(struct sdo_stats, 1);
+	stats->filter = g_strdup(filter);
+	stats->by_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+	error = register_tap_listener("epl-xdd.sdo", stats, filter, 0,
+			sdo_stats_reset, sdo_stats_packet, sdo_stats_draw);
+	if (error)
+	{
+		report_failure("Couldn't register " SDO_STATS_CLI " tap: %s", error->str);
+		g_string_free(error, TRUE);
+		g_hash_table_destroy(stats->by_index);
+		g_free(stats->filter);
+		g_free(stats);
+	}
+}
+
+static stat_tap_ui sdo_stats_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	SDO_STATS_CLI,
+	sdo_stats_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+epl_sdo_stats_register(void)
+{
+	register_stat_tap_ui(&sdo_stats_ui, NULL);
+}
+
+/* Cycle timing statistics
+ *
+ * Timestamps are the capture's. Per cycle, the SoC period, its
+ * cycle-to-cycle jitter and the isochronous phase (SoC to SoA) are
+ * accounted, per CN the PReq to PRes turnaround. A PReq that is
+ * followed by another PReq to the same CN before a PRes counts as
+ * missed. Each frame only touches the state of its cycle and its CN.
+ */
+
+#define CYCLE_STATS_CLI "epl-xdd,cycle"
+
+/* Log-linear histogram over nanoseconds: every power of two is split
+ * into CYCLE_HIST_SUB buckets, so a bucket is at most 1/16 of its
+ * values wide. Values from 2^40 ns (~18 minutes) on share the last one
+ */
+#define CYCLE_HIST_SUB_BITS 4
+#define CYCLE_HIST_SUB      (1 << CYCLE_HIST_SUB_BITS)
+#define CYCLE_HIST_BITS     40
+#define CYCLE_HIST_BUCKETS  ((CYCLE_HIST_BITS - CYCLE_HIST_SUB_BITS + 1) * CYCLE_HIST_SUB)
+
+struct cycle_hist {
+	guint64 count;
+	guint64 min, max;
+	double sum;
+	guint32 buckets[CYCLE_HIST_BUCKETS];
+};
+
+struct cycle_stats_node {
+	struct cycle_hist turnaround;
+	nstime_t preq;
+	gboolean preq_pending;
+	guint32 missed;
+};
+
+struct cycle_stats {
+	char *filter;
+	guint32 cycles;
+	gboolean have_soc, have_period, soa_seen;
+	nstime_t soc;
+	guint64 last_period;
+	struct cycle_hist period, jitter, isochronous;
+	struct cycle_stats_node *nodes[256];
+};
+
+static guint
+cycle_hist_bucket(guint64 ns)
+{
+	guint msb, shift;
+
+	if (ns < CYCLE_HIST_SUB)
+		return (guint)ns;
+	if (ns >> CYCLE_HIST_BITS)
+		return CYCLE_HIST_BUCKETS - 1;
+
+	for (msb = CYCLE_HIST_BITS - 1; !(ns >> msb); msb--)
+		;
+	shift = msb - CYCLE_HIST_SUB_BITS;
+	return (shift + 1) * CYCLE_HIST_SUB + (guint)((ns >> shift) & (CYCLE_HIST_SUB - 1));
+}
+
+/* smallest value of a bucket, the bucket is 1 << (bucket / SUB - 1) wide */
+static guint64
+cycle_hist_bucket_lower(guint bucket)
+{
+	guint group = bucket / CYCLE_HIST_SUB;
+
+	if (group <= 1)
+		return bucket;
+	return (guint64)(CYCLE_HIST_SUB + bucket % CYCLE_HIST_SUB) << (group - 1);
+}
+
+static void
+cycle_hist_add(struct cycle_hist *hist, guint64 ns)
+{
+	if (!hist->count || ns < hist->min)
+		hist->min = ns;
+	if (ns > hist->max)
+		hist->max = ns;
+	hist->sum += (double)ns;
+	hist->count++;
+	hist->buckets[cycle_hist_bucket(ns)]++;
+}
+
+/* in microseconds, accurate to the width of the bucket it falls in */
+static double
+cycle_hist_percentile(const struct cycle_hist *hist, double percent)
+{
+	guint64 rank = (guint64)(percent / 100.0 * (double)hist->count + 0.5);
+	guint64 seen = 0;
+	guint i;
+
+	if (rank < 1)
+		rank = 1;
+
+	for (i = 0; i < CYCLE_HIST_BUCKETS; i++)
+	{
+		seen += hist->buckets[i];
+		if (seen >= rank)
+		{
+			guint64 lower = cycle_hist_bucket_lower(i);
+			guint64 upper = i + 1 < CYCLE_HIST_BUCKETS ? cycle_hist_bucket_lower(i + 1) - 1 : hist->max;
+			guint64 mid = lower + (upper - lower) / 2;
+
+			if (mid < hist->min)
+				mid = hist->min;
+			if (mid > hist->max)
+				mid = hist->max;
+			return (double)mid / 1000.0;
+		}
+	}
+	return (double)hist->max / 1000.0;
+}
+
+/* nanoseconds from a to b, FALSE if b is before a */
+static gboolean
+cycle_stats_delta(const nstime_t *a, const nstime_t *b, guint64 *ns)
+{
+	nstime_t delta;
+
+	nstime_delta(&delta, b, a);
+	if (delta.secs < 0 || delta.nsecs < 0)
+		return FALSE;
+
+	*ns = (guint64)delta.secs * 1000000000 + (guint64)delta.nsecs;
+	return TRUE;
+}
+
+static struct cycle_stats_node *
+cycle_stats_node_get(struct cycle_stats *stats, guint8 node)
+{
+	if (!stats->nodes[node])
+		stats->nodes[node] = g_new0(struct cycle_stats_node, 1);
+
+	return stats->nodes[node];
+}
+
+static gboolean
+cycle_stats_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+	struct cycle_stats *stats = (struct cycle_stats*)tapdata;
+	const struct epl_info *info = (const struct epl_info*)data;
+	struct cycle_stats_node *node;
+	guint64 ns;
+
+	switch (info->mtyp)
+	{
+		case EPL_SOC:
+			if (stats->have_soc && cycle_stats_delta(&stats->soc, &pinfo->abs_ts, &ns))
+			{
+				cycle_hist_add(&stats->period, ns);
+				if (stats->have_period)
+					cycle_hist_add(&stats->jitter, ns > stats->last_period ? ns - stats->last_period
+					                                                       : stats->last_period - ns);
+				stats->last_period = ns;
+				stats->have_period = TRUE;
+			}
+			stats->soc = pinfo->abs_ts;
+			stats->have_soc = TRUE;
+			stats->soa_seen = FALSE;
+			stats->cycles++;
+			return TRUE;
+
+		case EPL_SOA:
+			if (!stats->have_soc || stats->soa_seen)
+				return FALSE;
+			if (cycle_stats_delta(&stats->soc, &pinfo->abs_ts, &ns))
+				cycle_hist_add(&stats->isochronous, ns);
+			stats->soa_seen = TRUE;
+			return TRUE;
+
+		case EPL_PREQ:
+			node = cycle_stats_node_get(stats, info->dest);
+			if (node->preq_pending)
+				node->missed++;
+			node->preq = pinfo->abs_ts;
+			node->preq_pending = TRUE;
+			return TRUE;
+
+		case EPL_PRES:
+			node = stats->nodes[info->src];
+			if (!node || !node->preq_pending)
+				return FALSE;
+			if (cycle_stats_delta(&node->preq, &pinfo->abs_ts, &ns))
+				cycle_hist_add(&node->turnaround, ns);
+			node->preq_pending = FALSE;
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+cycle_stats_reset(void *tapdata)
+{
+	struct cycle_stats *stats = (struct cycle_stats*)tapdata;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(stats->nodes); i++)
+	{
+		g_free(stats->nodes[i]);
+		stats->nodes[i] = NULL;
+	}
+	stats->cycles = 0;
+	stats->have_soc = stats->have_period = stats->soa_seen = FALSE;
+	memset(&stats->period, 0, sizeof stats->period);
+	memset(&stats->jitter, 0, sizeof stats->jitter);
+	memset(&stats->isochronous, 0, sizeof stats->isochronous);
+}
+
+static void
+cycle_stats_print_header(const char *label)
+{
+	printf("%-12s %9s %10s %10s %10s %10s %10s %10s %10s\n",
+			label, "Count", "Min[us]", "Avg[us]", "P50[us]", "P90[us]", "P99[us]", "P99.9[us]", "Max[us]");
+}
+
+static void
+cycle_stats_print_summary(const char *label, const struct cycle_hist *hist)
+{
+	if (!hist->count)
+		return;
+
+	printf("%-12s %9" G_GINT64_MODIFIER "u %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			label, hist->count,
+			(double)hist->min / 1000.0, hist->sum / (double)hist->count / 1000.0,
+			cycle_hist_percentile(hist, 50.0), cycle_hist_percentile(hist, 90.0),
+			cycle_hist_percentile(hist, 99.0), cycle_hist_percentile(hist, 99.9),
+			(double)hist->max / 1000.0);
+}
+
+/* one row per power of two, that's coarse enough to read */
+static void
+cycle_stats_print_hist(const char *title, const struct cycle_hist *hist)
+{
+	guint32 rows[CYCLE_HIST_BITS - CYCLE_HIST_SUB_BITS + 1];
+	guint32 peak = 0;
+	guint row, i;
+
+	if (!hist->count)
+		return;
+
+	memset(rows, 0, sizeof rows);
+	for (i = 0; i < CYCLE_HIST_BUCKETS; i++)
+		rows[i / CYCLE_HIST_SUB] += hist->buckets[i];
+	for (row = 0; row < G_N_ELEMENTS(rows); row++)
+		if (rows[row] > peak)
+			peak = rows[row];
+
+	printf("\n%s:\n", title);
+	for (row = 0; row < G_N_ELEMENTS(rows); row++)
+	{
+		guint64 lower = cycle_hist_bucket_lower(row * CYCLE_HIST_SUB);
+		guint64 upper = row + 1 < G_N_ELEMENTS(rows) ? cycle_hist_bucket_lower((row + 1) * CYCLE_HIST_SUB) : 0;
+		guint bar;
+
+		if (!rows[row])
+			continue;
+
+		bar = (guint)((guint64)rows[row] * 50 / peak);
+		if (upper)
+			printf(" %12.3f - %12.3f us %10u ", (double)lower / 1000.0, (double)upper / 1000.0, rows[row]);
+		else
+			printf(" %12.3f -              us %10u ", (double)lower / 1000.0, rows[row]);
+		while (bar--)
+			putchar('#');
+		putchar('\n');
+	}
+}
+
+static void
+cycle_stats_draw(void *tapdata)
+{
+	struct cycle_stats *stats = (struct cycle_stats*)tapdata;
+	struct cycle_hist turnaround;
+	char label[16];
+	guint i, j;
+
+	printf("\n");
+	printf("==========================================================================================\n");
+	printf("EPL Cycle Timing Statistics\n");
+	printf("Filter: %s\n", stats->filter ? stats->filter : "");
+	printf("Cycles: %u\n", stats->cycles);
+	printf("Jitter is the difference between consecutive SoC periods,\n");
+	printf("the isochronous phase lasts from SoC to SoA.\n");
+
+	printf("\nPer cycle:\n");
+	cycle_stats_print_header("");
+	cycle_stats_print_summary("SoC period", &stats->period);
+	cycle_stats_print_summary("SoC jitter", &stats->jitter);
+	cycle_stats_print_summary("Isochronous", &stats->isochronous);
+
+	printf("\nPReq to PRes turnaround per CN:\n");
+	cycle_stats_print_header("Node");
+	memset(&turnaround, 0, sizeof turnaround);
+	for (i = 0; i < G_N_ELEMENTS(stats->nodes); i++)
+	{
+		const struct cycle_stats_node *node = stats->nodes[i];
+		if (!node)
+			continue;
+		if (node->turnaround.count)
+		{
+			g_snprintf(label, sizeof label, "%u", i);
+			cycle_stats_print_summary(label, &node->turnaround);
+
+			if (!turnaround.count || node->turnaround.min < turnaround.min)
+				turnaround.min = node->turnaround.min;
+			if (node->turnaround.max > turnaround.max)
+				turnaround.max = node->turnaround.max;
+			turnaround.sum += node->turnaround.sum;
+			turnaround.count += node->turnaround.count;
+			for (j = 0; j < CYCLE_HIST_BUCKETS; j++)
+				turnaround.buckets[j] += node->turnaround.buckets[j];
+		}
+		if (node->missed)
+			printf("%-12u %u PReq(s) without PRes\n", i, node->missed);
+	}
+	cycle_stats_print_summary("All", &turnaround);
+
+	cycle_stats_print_hist("SoC period", &stats->period);
+	cycle_stats_print_hist("SoC jitter", &stats->jitter);
+	cycle_stats_print_hist("Isochronous phase", &stats->isochronous);
+	cycle_stats_print_hist("PReq to PRes turnaround, all CNs", &turnaround);
+
+	printf("==========================================================================================\n");
+}
+
+static void
+cycle_stats_init(const char *opt_arg, void *userdata _U_)
+{
+	struct cycle_stats *stats;
+	const char *filter = NULL;
+	GString *error;
+
+	if (g_str_has_prefix(opt_arg, CYCLE_STATS_CLI ","))
+		filter = opt_arg + strlen(CYCLE_STATS_CLI ",");
+
+	stats = g_new0(struct cycle_stats, 1);
+	stats->filter = g_strdup(filter);
+
+	error = register_tap_listener("epl-xdd", stats, filter, 0,
+			cycle_stats_reset, cycle_stats_packet, cycle_stats_draw);
+	if (error)
+	{
+		report_failure("Couldn't register " CYCLE_STATS_CLI " tap: %s", error->str);
+		g_string_free(error, TRUE);
+		g_free(stats->filter);
+		g_free(stats);
+	}
+}
+
+static stat_tap_ui cycle_stats_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	CYCLE_STATS_CLI,
+	cycle_stats_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+epl_cycle_stats_register(void)
+{
+	register_stat_tap_ui(&cycle_stats_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
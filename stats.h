@@ -0,0 +1,32 @@
+/* stats.h
+ * Statistics for Ethernet POWERLINK, fed by the EPL+XDD dissector's taps
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef WIRESHARK_EPL_STATS_H_
+#define WIRESHARK_EPL_STATS_H_
+
+/* -z epl-xdd,sdo[,filter] */
+void epl_sdo_stats_register(void);
+
+/* -z epl-xdd,cycle[,filter] */
+void epl_cycle_stats_register(void);
+
+#endif
@@ -80,6 +80,23 @@ epl_wmem_iarray_insert(epl_wmem_iarray_t *iarr, guint32 where, range_admin_t *da
 	g_array_append_vals(iarr->arr, data, 1);
 }
 
+void
+epl_wmem_iarray_append_range(epl_wmem_iarray_t *iarr, guint32 low, guint32 high, range_admin_t *data)
+{
+	const range_admin_t *last;
+
+	if (iarr->arr->len) {
+		last = (const range_admin_t*)(iarr->arr->data
+				+ (iarr->arr->len - 1) * g_array_get_element_size(iarr->arr));
+		if (last->high >= low)
+			iarr->is_sorted = FALSE;
+	}
+
+	data->low = low;
+	data->high = high;
+	g_array_append_vals(iarr->arr, data, 1);
+}
+
 static int
 cmp(const void *_a, const void *_b)
 {
@@ -147,6 +164,23 @@ epl_wmem_iarray_find(epl_wmem_iarray_t *iarr, guint32 value) {
 	return (range_admin_t*)bsearch_garray(&needle, iarr->arr, find_in_range);
 }
 
+guint
+epl_wmem_iarray_len(epl_wmem_iarray_t *iarr)
+{
+	epl_wmem_iarray_sort(iarr);
+	return iarr->arr->len;
+}
+
+range_admin_t *
+epl_wmem_iarray_index(epl_wmem_iarray_t *iarr, guint i)
+{
+	epl_wmem_iarray_sort(iarr);
+	if (i >= iarr->arr->len)
+		return NULL;
+
+	return (range_admin_t*)(iarr->arr->data + i * g_array_get_element_size(iarr->arr));
+}
+
 /** For debugging purposes */
 void
 epl_wmem_print_iarr(epl_wmem_iarray_t *iarr)
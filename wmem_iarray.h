@@ -84,6 +84,15 @@ epl_wmem_iarray_is_sorted(epl_wmem_iarray_t *iarr);
 void
 epl_wmem_iarray_insert(epl_wmem_iarray_t *iarr, guint32 where, range_admin_t *data);
 
+/**
+ * Appends an element already covering [low, high]. Appending in ascending
+ * order keeps the array sorted, so no combining happens at sort-time.
+ * This is meant for restoring an array that was sorted before
+ */
+
+void
+epl_wmem_iarray_append_range(epl_wmem_iarray_t *iarr, guint32 low, guint32 high, range_admin_t *data);
+
 /** Makes array suitable for searching */
 
 void
@@ -97,6 +106,15 @@ epl_wmem_iarray_sort(epl_wmem_iarray_t *iarr);
 range_admin_t *
 epl_wmem_iarray_find(epl_wmem_iarray_t *arr, guint32 value);
 
+/** Returns the number of elements. Sorts the array first */
+
+guint
+epl_wmem_iarray_len(epl_wmem_iarray_t *iarr);
+
+/** Returns the i-th element in ascending order. Sorts the array first */
+
+range_admin_t *
+epl_wmem_iarray_index(epl_wmem_iarray_t *iarr, guint i);
 
 /** Print ranges within the iarr */
 
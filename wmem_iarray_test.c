@@ -15,8 +15,9 @@ gboolean equal(gconstpointer _a, gconstpointer _b) {
 }
 
 int main(void) {
-	epl_wmem_iarray_t *iarr;
+	epl_wmem_iarray_t *iarr, *copy;
 	int i;
+	guint n;
 	struct entry *pentry;
 	struct entry entry = {
 		{ 0, 0 },
@@ -63,6 +64,29 @@ int main(void) {
 		}
 	}
 
+	puts("------");
+
+	/* restoring the sorted ranges must give the same array */
+	copy = epl_wmem_iarray_new(NULL, sizeof (struct entry), equal);
+	assert(copy);
+	for (n = 0; n < epl_wmem_iarray_len(iarr); n++) {
+		pentry = (struct entry*)epl_wmem_iarray_index(iarr, n);
+		entry.value = pentry->value;
+		epl_wmem_iarray_append_range(copy, pentry->range.low, pentry->range.high, &entry.range);
+	}
+	assert(epl_wmem_iarray_is_sorted(copy));
+	assert(epl_wmem_iarray_len(copy) == epl_wmem_iarray_len(iarr));
+	assert(epl_wmem_iarray_index(copy, epl_wmem_iarray_len(copy)) == NULL);
+
+	epl_wmem_print_iarr(copy);
+
+	for (i = 0; i < 20; i++) {
+		struct entry *a = (struct entry*)epl_wmem_iarray_find(iarr, i),
+		             *b = (struct entry*)epl_wmem_iarray_find(copy, i);
+		assert(!a == !b);
+		assert(!a || (a->value == b->value && a->range.low == b->range.low && a->range.high == b->range.high));
+	}
+
 	return 0;
 }
 
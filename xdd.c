@@ -27,10 +27,7 @@
 #include <glib.h>
 #include <string.h>
 
-#include <libxml/tree.h>
-#include <libxml/parser.h>
-#include <libxml/xpath.h>
-#include <libxml/xpathInternals.h>
+#include <libxml/xmlreader.h>
 #include <errno.h>
 
 #include "wmem_iarray.h"
@@ -61,222 +58,358 @@ xdd_free(void)
 	xmlCleanupParser();
 }
 
-#if !defined(LIBXML_XPATH_ENABLED) \
-||  !defined(LIBXML_SAX1_ENABLED)  \
-||  !defined(LIBXML_TREE_ENABLED)
-#error "packet-epl.c needs XPATH, SAX1 and TREE support compiled in!"
+#if !defined(LIBXML_READER_ENABLED)
+#error "packet-epl.c needs xmlReader support compiled in!"
 #endif
 
-typedef int xpath_handler(xmlNodeSetPtr, void*);
-static xpath_handler populate_objectList, populate_dataTypeList, populate_profileName;
+#define XDD_NS  "http://www.ethernet-powerlink.org"
+#define XSI_NS  "http://www.w3.org/2001/XMLSchema-instance"
 
-static struct xpath_namespace {
-	const xmlChar *prefix, *href;
-} namespaces[] = {
-	{ BAD_CAST "x",   BAD_CAST "http://www.ethernet-powerlink.org" },
-	{ BAD_CAST "xsi", BAD_CAST "http://www.w3.org/2001/XMLSchema-instance" },
-	{ NULL, NULL }
+/* The XDD is read in a single forward pass. Of the elements on the
+ * current path, only the ones leading to the parts we are interested
+ * in are told apart:
+ *
+ * //ISO15745Profile/ProfileHeader/{ProfileIdentification,ProfileName}
+ * //ProfileBody[@xsi:type='ProfileBody_CommunicationNetwork_Powerlink']
+ *   /ApplicationLayers/{DataTypeList/defType,ObjectList/Object/SubObject}
+ */
+enum xdd_elem {
+	XDD_OTHER,
+	XDD_PROFILE,
+	XDD_HEADER,
+	XDD_IDENTIFICATION,
+	XDD_NAME,
+	XDD_BODY,
+	XDD_APPLICATION_LAYERS,
+	XDD_DATA_TYPE_LIST,
+	XDD_DEF_TYPE,
+	XDD_OBJECT_LIST,
+	XDD_OBJECT,
+	XDD_SUB_OBJECT
 };
 
-static struct xpath {
-	const xmlChar *expr;
-	xpath_handler *handler;
-} xpaths[] = {
-	{
-		BAD_CAST "//x:ISO15745Profile[x:ProfileHeader/x:ProfileIdentification='Powerlink_Communication_Profile']/x:ProfileHeader/x:ProfileName",
-		populate_profileName
-	},
-	{
-		BAD_CAST "//x:ProfileBody[@xsi:type='ProfileBody_CommunicationNetwork_Powerlink']/x:ApplicationLayers/x:DataTypeList/x:defType",
-		populate_dataTypeList
-	},
-	{
-		BAD_CAST "//x:ProfileBody[@xsi:type='ProfileBody_CommunicationNetwork_Powerlink']/x:ApplicationLayers/x:ObjectList/x:Object",
-		populate_objectList
-	},
-	{ NULL, NULL }
+/* Deeper elements are never interesting, they only need to be skipped */
+#define XDD_MAX_DEPTH 32
+
+struct xdd_reader {
+	xmlTextReaderPtr reader;
+	struct profile *profile;
+	enum xdd_elem path[XDD_MAX_DEPTH];
+
+	gboolean communication_profile; /* of the current ProfileHeader */
+	guint16 def_type;               /* dataType of the current defType */
+
+	struct object *obj;             /* current Object */
+	struct subobject subobj;
 };
 
-struct profile *
-xdd_load(struct profile *profile, const char *xml_file)
+static gboolean parse_obj_tag(xmlTextReaderPtr reader, struct od_entry *out, struct profile *profile);
+
+static gboolean
+xdd_is(xmlTextReaderPtr reader, const char *name)
 {
-	xmlXPathContextPtr xpathCtx = NULL;
-	xmlDoc *doc = NULL;
-	struct xpath_namespace *ns = NULL;
-	struct xpath *xpath = NULL;
-	GHashTable *typemap = NULL;
+	const xmlChar *ns = xmlTextReaderConstNamespaceUri(reader);
+
+	return ns && xmlStrEqual(ns, BAD_CAST XDD_NS)
+	    && xmlStrEqual(xmlTextReaderConstLocalName(reader), BAD_CAST name);
+}
 
-	/* Load XML document */
-	doc = xmlParseFile(xml_file);
-	if (!doc)
+static gboolean
+xdd_is_powerlink_body(xmlTextReaderPtr reader)
+{
+	xmlChar *type;
+	gboolean ret;
+
+	if (!xdd_is(reader, "ProfileBody"))
+		return FALSE;
+
+	type = xmlTextReaderGetAttributeNs(reader, BAD_CAST "type", BAD_CAST XSI_NS);
+	ret = type && xmlStrEqual(type, BAD_CAST "ProfileBody_CommunicationNetwork_Powerlink");
+	xmlFree(type);
+
+	return ret;
+}
+
+/* what an element is, given what its parent is */
+static enum xdd_elem
+xdd_classify(xmlTextReaderPtr reader, enum xdd_elem parent)
+{
+	switch (parent)
 	{
-		g_warning("Error: unable to parse file \"%s\"\n", xml_file);
-		profile = NULL;
-		goto cleanup;
+		case XDD_PROFILE:
+			if (xdd_is(reader, "ProfileHeader"))         return XDD_HEADER;
+			break;
+		case XDD_HEADER:
+			if (xdd_is(reader, "ProfileIdentification")) return XDD_IDENTIFICATION;
+			if (xdd_is(reader, "ProfileName"))           return XDD_NAME;
+			break;
+		case XDD_BODY:
+			if (xdd_is(reader, "ApplicationLayers"))     return XDD_APPLICATION_LAYERS;
+			break;
+		case XDD_APPLICATION_LAYERS:
+			if (xdd_is(reader, "DataTypeList"))          return XDD_DATA_TYPE_LIST;
+			if (xdd_is(reader, "ObjectList"))            return XDD_OBJECT_LIST;
+			break;
+		case XDD_DATA_TYPE_LIST:
+			if (xdd_is(reader, "defType"))               return XDD_DEF_TYPE;
+			break;
+		case XDD_OBJECT_LIST:
+			if (xdd_is(reader, "Object"))                return XDD_OBJECT;
+			break;
+		case XDD_OBJECT:
+			/* all element children of an Object are its subobjects */
+			return XDD_SUB_OBJECT;
+		default:
+			break;
 	}
 
+	/* these may appear anywhere */
+	if (xdd_is(reader, "ISO15745Profile"))
+		return XDD_PROFILE;
+	if (xdd_is_powerlink_body(reader))
+		return XDD_BODY;
+
+	return XDD_OTHER;
+}
 
-	/* Create xpath evaluation context */
-	xpathCtx = xmlXPathNewContext(doc);
-	if(!xpathCtx)
+struct dataType {
+	guint16 id;
+	const struct epl_datatype *ptr;
+};
+
+static void
+populate_dataType(struct xdd_reader *xdd)
+{
+	struct dataType *type;
+	const struct epl_datatype *ptr = epl_type_to_hf((const char*)xmlTextReaderConstLocalName(xdd->reader));
+	if (!ptr)
 	{
-		g_warning("Error: unable to create new XPath context\n");
-		profile = NULL;
-		goto cleanup;
+		EPL_INFO("Skipping unknown type '%s'\n", xmlTextReaderConstLocalName(xdd->reader));
+		return;
 	}
+	type = g_new(struct dataType, 1);
+	type->id = xdd->def_type;
+	type->ptr = ptr;
+	g_hash_table_insert((GHashTable*)xdd->profile->data, &type->id, type);
+}
+
+static gboolean
+begin_defType(struct xdd_reader *xdd)
+{
+	char *endptr;
+	xmlChar *val = xmlTextReaderGetAttribute(xdd->reader, BAD_CAST "dataType");
+	gboolean valid = FALSE;
 
-	/* Register namespaces from list */
-	for (ns = namespaces; ns->href; ns++)
+	if (val)
 	{
-		if(xmlXPathRegisterNs(xpathCtx, ns->prefix, ns->href) != 0)
-		{
-			g_warning("Error: unable to register NS with prefix=\"%s\" and href=\"%s\"\n", ns->prefix, ns->href);
-			profile = NULL;
-			goto cleanup;
-		}
+		xdd->def_type = epl_strtou16((const char*)val, &endptr, 16);
+		valid = endptr != (char*)val;
+		xmlFree(val);
 	}
 
-	profile->path = wmem_strdup(profile->scope, xml_file);
+	return valid;
+}
 
-	/* mapping type ids to &hf_s */
-	profile->data = typemap = (GHashTable*)g_hash_table_new_full(epl_g_int16_hash, epl_g_int16_equal, NULL, g_free);
+static void
+begin_object(struct xdd_reader *xdd)
+{
+	struct od_entry tmpobj = {0};
 
-	/* Evaluate xpath expressions */
-	for (xpath = xpaths; xpath->expr; xpath++)
-	{
-		xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(xpath->expr, xpathCtx);
-		if (!xpathObj || !xpathObj->nodesetval)
-		{
-			g_warning("Error: unable to evaluate xpath expression \"%s\"\n", xpath->expr);
-			xmlXPathFreeObject(xpathObj);
-			profile = NULL;
-			goto cleanup;
-		}
+	xdd->obj = NULL;
+	parse_obj_tag(xdd->reader, &tmpobj, xdd->profile);
 
-		/* run handler */
-		if (xpath->handler && xpathObj->nodesetval->nodeNr)
-			xpath->handler(xpathObj->nodesetval, profile);
-		xmlXPathFreeObject(xpathObj);
-	}
+	if (!tmpobj.idx)
+		return;
 
-	/* We create ObjectMappings while reading the XML, this is makes it likely,
-	 * that we won't be able to reference a mapped object in the ObjectMapping
-	 * as we didn't reach its XML tag yet. Therefore, after reading the XDD
-	 * completely, we update mappings in the profile
-	 */
-	profile_object_mappings_update(profile);
+	xdd->obj = profile_object_add(xdd->profile, tmpobj.idx);
+	xdd->obj->info = tmpobj;
+
+	if (tmpobj.type_class == 8 || tmpobj.type_class == 9)
+	{
+		xdd->obj->subindices = epl_wmem_iarray_new(xdd->profile->scope, sizeof (struct subobject), subobject_equal);
+		memset(&xdd->subobj, 0, sizeof xdd->subobj);
+	}
+}
 
-cleanup:
-	if (typemap)
-		g_hash_table_destroy(typemap);
+static void
+populate_subObject(struct xdd_reader *xdd)
+{
+	struct object *obj = xdd->obj;
+	struct subobject *subobj = &xdd->subobj;
 
-	if (xpathCtx)
-		xmlXPathFreeContext(xpathCtx);
-	if (doc)
-		xmlFreeDoc(doc);
+	if (!obj || !obj->subindices)
+		return;
 
-	return profile;
+	if (parse_obj_tag(xdd->reader, &subobj->info, xdd->profile))
+	{
+		epl_wmem_iarray_insert(obj->subindices,
+				subobj->info.idx, &subobj->range);
+	}
+	/* Only recorded here, profile_load() builds the mappings once
+	 * all objects they may reference are read
+	 */
+	if (subobj->info.value && profile_object_mapping_add(xdd->profile, obj->info.idx, subobj->info.idx, subobj->info.value))
+	{
+		EPL_INFO("Loaded mapping from XDC %s:%s", obj->info.name, subobj->info.name);
+	}
 }
 
-void
-xdd_unload()
+static void
+end_object(struct xdd_reader *xdd)
 {
+	if (xdd->obj && xdd->obj->subindices)
+		epl_wmem_iarray_sort(xdd->obj->subindices);
+	xdd->obj = NULL;
 }
 
-static int
-populate_profileName(xmlNodeSetPtr nodes, void *_profile)
+static void
+xdd_start_element(struct xdd_reader *xdd, int depth, gboolean empty)
 {
-	struct profile *profile = (struct profile*)_profile;
-	if (nodes->nodeNr == 1
-	&&  nodes->nodeTab[0]->type == XML_ELEMENT_NODE
-	&&  nodes->nodeTab[0]->children)
+	enum xdd_elem parent = depth > 0 ? xdd->path[depth - 1] : XDD_OTHER;
+	enum xdd_elem elem = xdd_classify(xdd->reader, parent);
+	xmlChar *text;
+
+	switch (elem)
 	{
-		profile->name = wmem_strdup(profile->scope, (char*)nodes->nodeTab[0]->children->content);
-		return 0;
+		case XDD_HEADER:
+			xdd->communication_profile = FALSE;
+			break;
+
+		case XDD_IDENTIFICATION:
+			text = xmlTextReaderReadString(xdd->reader);
+			xdd->communication_profile = text && xmlStrEqual(text, BAD_CAST "Powerlink_Communication_Profile");
+			xmlFree(text);
+			break;
+
+		case XDD_NAME:
+			if (xdd->communication_profile && !xdd->profile->name)
+			{
+				text = xmlTextReaderReadString(xdd->reader);
+				if (text && *text)
+					xdd->profile->name = wmem_strdup(xdd->profile->scope, (const char*)text);
+				xmlFree(text);
+			}
+			break;
+
+		case XDD_DEF_TYPE:
+			if (!begin_defType(xdd))
+				elem = XDD_OTHER;
+			break;
+
+		case XDD_OBJECT:
+			begin_object(xdd);
+			if (empty)
+				end_object(xdd);
+			break;
+
+		case XDD_SUB_OBJECT:
+			populate_subObject(xdd);
+			break;
+
+		case XDD_OTHER:
+			/* the type of a defType is its child's element name */
+			if (parent == XDD_DEF_TYPE)
+				populate_dataType(xdd);
+			break;
+
+		default:
+			break;
 	}
 
-	return -1;
+	if (!empty && depth < XDD_MAX_DEPTH)
+		xdd->path[depth] = elem;
 }
 
-struct dataType {
-	guint16 id;
-	const struct epl_datatype *ptr;
-};
+static void
+xdd_end_element(struct xdd_reader *xdd, int depth)
+{
+	if (depth >= XDD_MAX_DEPTH)
+		return;
 
-static int
-populate_dataTypeList(xmlNodeSetPtr nodes, void *_profile)
+	if (xdd->path[depth] == XDD_OBJECT)
+		end_object(xdd);
+	xdd->path[depth] = XDD_OTHER;
+}
+
+struct profile *
+xdd_load(struct profile *profile, const char *xml_file)
 {
-	xmlNodePtr cur;
-	int i;
-	struct profile *profile = (struct profile*)_profile;
+	struct xdd_reader xdd;
+	GHashTable *typemap = NULL;
+	int ret;
 
-	for(i = 0; i < nodes->nodeNr; ++i)
+	memset(&xdd, 0, sizeof xdd);
+	xdd.profile = profile;
+
+	xdd.reader = xmlReaderForFile(xml_file, NULL, XML_PARSE_NONET);
+	if (!xdd.reader)
 	{
-		xmlAttrPtr attr;
+		g_warning("Error: unable to open file \"%s\"\n", xml_file);
+		return NULL;
+	}
 
-		if(!nodes->nodeTab[i] || nodes->nodeTab[i]->type != XML_ELEMENT_NODE)
-			return -1;
+	profile->path = wmem_strdup(profile->scope, xml_file);
 
-		cur = nodes->nodeTab[i];
+	/* mapping type ids to &hf_s */
+	profile->data = typemap = (GHashTable*)g_hash_table_new_full(epl_g_int16_hash, epl_g_int16_equal, NULL, g_free);
 
+	while ((ret = xmlTextReaderRead(xdd.reader)) == 1)
+	{
+		int depth = xmlTextReaderDepth(xdd.reader);
 
-		for(attr = cur->properties; attr; attr = attr->next)
+		switch (xmlTextReaderNodeType(xdd.reader))
 		{
-			char *endptr;
-			const char *key = (const char*)attr->name;
-			const char *val = (const char*)attr->children->content;
+			case XML_READER_TYPE_ELEMENT:
+				if (depth >= XDD_MAX_DEPTH)
+					break;
+				xdd_start_element(&xdd, depth, xmlTextReaderIsEmptyElement(xdd.reader) == 1);
+				break;
+			case XML_READER_TYPE_END_ELEMENT:
+				xdd_end_element(&xdd, depth);
+				break;
+			default:
+				break;
+		}
+	}
 
-			if (g_str_equal("dataType", key))
-			{
-				xmlNode *subnode;
-				guint16 idx = epl_strtou16(val, &endptr, 16);
-				if (endptr == val) continue;
+	if (ret != 0)
+	{
+		g_warning("Error: unable to parse file \"%s\"\n", xml_file);
+		profile = NULL;
+	}
 
-				for (subnode = cur->children; subnode; subnode = subnode->next)
-				{
-					if (subnode->type == XML_ELEMENT_NODE)
-					{
-						struct dataType *type;
-						const struct epl_datatype *ptr = epl_type_to_hf((char*)subnode->name);
-						if (!ptr)
-						{
-							EPL_INFO("Skipping unknown type '%s'\n", subnode->name);
-							continue;
-						}
-						type = g_new(struct dataType, 1);
-						type->id = idx;
-						type->ptr = ptr;
-						g_hash_table_insert((GHashTable*)profile->data, &type->id, type);
-						continue;
-					}
-				}
+	g_hash_table_destroy(typemap);
+	xmlFreeTextReader(xdd.reader);
 
-			}
-		}
-	}
+	return profile;
+}
 
-	return 0;
+void
+xdd_unload()
+{
 }
 
 static gboolean
-parse_obj_tag(xmlNode *cur, struct od_entry *out, struct profile *profile) {
-		xmlAttrPtr attr;
-		const char *defaultValue = NULL, *actualValue = NULL, *value;
+parse_obj_tag(xmlTextReaderPtr reader, struct od_entry *out, struct profile *profile) {
+		guint64 defaultValue = 0, actualValue = 0;
+		gboolean hasDefault = FALSE, hasActual = FALSE, valid = TRUE;
 		char *endptr;
 
-		for(attr = cur->properties; attr; attr = attr->next)
+		/* attribute values may not outlive the next attribute, so they
+		 * are all converted right away */
+		while (valid && xmlTextReaderMoveToNextAttribute(reader) == 1)
 		{
-			const char *key = (char*)attr->name,
-				  *val = (char*)attr->children->content;
+			const char *key = (const char*)xmlTextReaderConstLocalName(reader),
+				  *val = (const char*)xmlTextReaderConstValue(reader);
 
 			if (g_str_equal("index", key))
 			{
 				out->idx = epl_strtou16(val, &endptr, 16);
-				if (val == endptr) return FALSE;
+				if (val == endptr) valid = FALSE;
 
 			} else if (g_str_equal("subIndex", key)) {
 				out->idx = epl_strtou16(val, &endptr, 16);
-				if (val == endptr) return FALSE;
+				if (val == endptr) valid = FALSE;
 
 			} else if (g_str_equal("name", key)) {
 				g_strlcpy(out->name, val, sizeof out->name);
@@ -293,77 +426,30 @@ parse_obj_tag(xmlNode *cur, struct od_entry *out, struct profile *profile) {
 				}
 
 			} else if (g_str_equal("defaultValue", key)) {
-				defaultValue = val;
+				defaultValue = g_ascii_strtoull(val, &endptr, 0);
+				hasDefault = TRUE;
 
 			} else if (g_str_equal("actualValue", key)) {
-				actualValue = val;
+				actualValue = g_ascii_strtoull(val, &endptr, 0);
+				hasActual = TRUE;
 			}
 			/*else if (g_str_equal("PDOmapping", key)) {
 			  obj.PDOmapping = get_index(ObjectPDOmapping_tostr, val);
 			  assert(obj.PDOmapping >= 0);
 			  }*/
 		}
+		xmlTextReaderMoveToElement(reader);
 
-		value = actualValue ? actualValue
-		      : defaultValue ? defaultValue
-		      : NULL;
+		if (!valid)
+			return FALSE;
 
-		out->value = value ? g_ascii_strtoull(value, &endptr, 0) : 0;
+		out->value = hasActual ? actualValue
+		           : hasDefault ? defaultValue
+		           : 0;
 
 		return TRUE;
 }
 
-static int
-populate_objectList(xmlNodeSetPtr nodes, void *_profile)
-{
-	int i;
-	struct profile *profile = (struct profile*)_profile;
-
-	for(i = 0; i < nodes->nodeNr; ++i)
-	{
-		xmlNodePtr cur = nodes->nodeTab[i];
-		struct od_entry tmpobj = {0};
-
-		if (!nodes->nodeTab[i] || nodes->nodeTab[i]->type != XML_ELEMENT_NODE)
-			continue;
-
-		parse_obj_tag(cur, &tmpobj, profile);
-
-		if (tmpobj.idx)
-		{
-			struct object *obj = profile_object_add(profile, tmpobj.idx);
-			obj->info = tmpobj;
-
-			if (tmpobj.type_class == 8 || tmpobj.type_class == 9)
-			{
-				xmlNode *subcur;
-				struct subobject subobj = {0};
-
-				obj->subindices = epl_wmem_iarray_new(profile->scope, sizeof (struct subobject), subobject_equal);
-
-				for (subcur = cur->children; subcur; subcur = subcur->next)
-				{
-					if (subcur->type != XML_ELEMENT_NODE)
-						continue;
-
-					if (parse_obj_tag(subcur, &subobj.info, profile))
-					{
-						epl_wmem_iarray_insert(obj->subindices,
-								subobj.info.idx, &subobj.range);
-					}
-					if (subobj.info.value && profile_object_mapping_add(profile, obj->info.idx, subobj.info.idx, subobj.info.value))
-					{
-						EPL_INFO("Loaded mapping from XDC %s:%s", obj->info.name, subobj.info.name);
-					}
-				}
-				epl_wmem_iarray_sort(obj->subindices);
-			}
-		}
-	}
-
-	return 0;
-}
-
 /*
  * Editor modelines  -	http://www.wireshark.org/tools/modelines.html
  *